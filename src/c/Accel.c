@@ -0,0 +1,179 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Accel.c
+   Notes   : Batched accelerometer feed, shared by the camera and the oscillator modes.
+           : Each batch is filtered once on arrival and kept in a ring buffer, readers never call the accelerometer service.
+*/
+
+#include "Accel.h"
+#include "main.h"
+#include "Profile.h"
+#include "Trace.h"
+
+
+static AccelSample  s_accel_ring[ACCEL_RING_CAPACITY] ;   // Raw samples, the oldest overwritten first.
+static int          s_accel_ringNum    = 0 ;
+static int          s_accel_ringNewest = 0 ;
+static int32_t      s_accel_ringSum[3] ;                  // Running sums of the ring samples, per axis.
+static int32_t      s_accel_ema[3] ;                      // Exponential moving average, mG << ACCEL_EMA_SHIFT.
+static AccelSample  s_accel_emaSample ;                   // The average in mG.
+
+static int          s_accel_wakeupsNum ;                  // Sensor path counters, since the last report.
+static int          s_accel_samplesNum ;
+static int          s_accel_callsNum ;
+
+
+// Fixed point EMA step of one axis: ema += (sample - ema) / 2^ACCEL_EMA_LEVEL. Returns the filtered value in mG.
+inline
+static
+int16_t
+accel_ema_push
+( int32_t       *ema
+, const int16_t  sample
+)
+{
+  *ema += (((int32_t)sample << ACCEL_EMA_SHIFT) - *ema) >> ACCEL_EMA_LEVEL ;
+  return *ema >> ACCEL_EMA_SHIFT ;
+}
+
+
+static
+void
+accel_ring_push
+( const AccelSample sample )
+{
+  if (s_accel_ringNum < ACCEL_RING_CAPACITY)
+    s_accel_ringNewest = s_accel_ringNum++ ;
+  else
+  {
+    s_accel_ringNewest = (s_accel_ringNewest + 1) % ACCEL_RING_CAPACITY ;
+
+    s_accel_ringSum[0] -= s_accel_ring[s_accel_ringNewest].x ;
+    s_accel_ringSum[1] -= s_accel_ring[s_accel_ringNewest].y ;
+    s_accel_ringSum[2] -= s_accel_ring[s_accel_ringNewest].z ;
+  }
+
+  s_accel_ring[s_accel_ringNewest] = sample ;
+
+  s_accel_ringSum[0] += sample.x ;
+  s_accel_ringSum[1] += sample.y ;
+  s_accel_ringSum[2] += sample.z ;
+}
+
+
+#ifndef TRACE_REPLAY
+  static
+  void
+  accel_data_handler
+  ( AccelData *data
+  , uint32_t   num_samples
+  )
+  {
+    PROFILE_SCOPE( PROFILE_ACCEL ) ;
+
+    ++s_accel_wakeupsNum ;
+
+    for (uint32_t i = 0  ;  i < num_samples  ;  ++i)
+    {
+      if (data[i].did_vibrate)    // Vibration motor noise, not wrist movement.
+        continue ;
+
+      const AccelSample sample = { .x = data[i].x, .y = data[i].y, .z = data[i].z } ;
+
+  #ifdef TRACE_RECORD
+      Trace_record_accel( sample ) ;
+  #endif
+
+      Accel_feed( sample ) ;
+    }
+  }
+#endif
+
+
+void
+Accel_feed
+( const AccelSample sample )
+{
+  if (s_accel_ringNum == 0)
+  {
+    // First sample since started: start the average there instead of ramping up from 0.
+    s_accel_ema[0] = (int32_t)sample.x << ACCEL_EMA_SHIFT ;
+    s_accel_ema[1] = (int32_t)sample.y << ACCEL_EMA_SHIFT ;
+    s_accel_ema[2] = (int32_t)sample.z << ACCEL_EMA_SHIFT ;
+  }
+
+  s_accel_emaSample = (AccelSample){ .x = accel_ema_push( &s_accel_ema[0], sample.x )
+                                    , .y = accel_ema_push( &s_accel_ema[1], sample.y )
+                                    , .z = accel_ema_push( &s_accel_ema[2], sample.z )
+                                    } ;
+
+  accel_ring_push( sample ) ;
+
+  ++s_accel_samplesNum ;
+}
+
+
+void
+Accel_start
+( const AccelSamplingRate  rate
+, const uint32_t           batchSamples
+)
+{
+  Accel_stop( ) ;
+
+#ifndef TRACE_REPLAY
+  accel_data_service_subscribe( batchSamples, accel_data_handler ) ;
+  accel_service_set_sampling_rate( rate ) ;
+  s_accel_callsNum += 2 ;
+#endif
+}
+
+
+void
+Accel_stop
+( )
+{
+  accel_data_service_unsubscribe( ) ;
+  ++s_accel_callsNum ;
+
+  s_accel_ringNum    = s_accel_ringNewest = 0 ;
+  s_accel_ringSum[0] = s_accel_ringSum[1] = s_accel_ringSum[2] = 0 ;
+}
+
+
+bool
+Accel_latest
+( AccelSample *sample )
+{
+  if (s_accel_ringNum == 0)
+    return false ;
+
+  *sample = s_accel_emaSample ;
+  return true ;
+}
+
+
+bool
+Accel_mean
+( AccelSample *mean )
+{
+  if (s_accel_ringNum == 0)
+    return false ;
+
+  mean->x = s_accel_ringSum[0] / s_accel_ringNum ;
+  mean->y = s_accel_ringSum[1] / s_accel_ringNum ;
+  mean->z = s_accel_ringSum[2] / s_accel_ringNum ;
+  return true ;
+}
+
+
+void
+Accel_stats_report
+( )
+{
+  LOGD( "accel:: %d wake ups, %d samples, %d service calls"
+      , s_accel_wakeupsNum, s_accel_samplesNum, s_accel_callsNum
+      ) ;
+
+  s_accel_wakeupsNum = s_accel_samplesNum = s_accel_callsNum = 0 ;
+}
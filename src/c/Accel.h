@@ -0,0 +1,45 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Accel.h
+   Notes   : Batched accelerometer feed, shared by the camera and the oscillator modes.
+           : Each batch is filtered once on arrival and kept in a ring buffer, readers never call the accelerometer service.
+*/
+
+#pragma once
+
+#include <pebble.h>
+
+
+// Accelerometer reading in mG.
+typedef struct
+{
+  int16_t x ;
+  int16_t y ;
+  int16_t z ;
+} AccelSample ;
+
+
+// Subscribes to the accelerometer data service, batchSamples samples per wake up at the given sampling rate. With
+// TRACE_REPLAY (BENCH included) the samples come from the trace through Accel_feed( ) instead.
+void
+Accel_start
+( const AccelSamplingRate  rate
+, const uint32_t           batchSamples
+) ;
+
+// Unsubscribes from the accelerometer data service and forgets all samples.
+void Accel_stop( ) ;
+
+// Exponential moving average of the samples, up to the latest. Returns false, leaving *sample alone, while no sample
+// arrived yet.
+bool Accel_latest( AccelSample *sample ) ;
+
+// Mean of the raw samples held by the ring buffer. Returns false, leaving *mean alone, while empty.
+bool Accel_mean( AccelSample *mean ) ;
+
+// Filters a raw sample into the average and the ring buffer, as if the accelerometer service had delivered it.
+void Accel_feed( const AccelSample sample ) ;
+
+// Logs and clears the sensor path counters: wake ups, samples and accelerometer service calls since the last report.
+// The time spent in the accelerometer handler is the "accel" stage of the PROFILE report.
+void Accel_stats_report( ) ;
@@ -0,0 +1,20 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Clock.c
+   Notes   : Millisecond wall clock, shared by the frame pacing, the profiler, the telemetry and the input trace.
+*/
+
+#include "Clock.h"
+
+
+uint32_t
+Clock_ms
+( )
+{
+  time_t   seconds ;
+  uint16_t milliseconds ;
+
+  time_ms( &seconds, &milliseconds ) ;
+
+  return (uint32_t)seconds * 1000 + milliseconds ;
+}
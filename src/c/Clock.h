@@ -0,0 +1,13 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Clock.h
+   Notes   : Millisecond wall clock, shared by the frame pacing, the profiler, the telemetry and the input trace.
+*/
+
+#pragma once
+
+#include <pebble.h>
+
+
+// Milliseconds of time_ms( ). Wraps around, only ever use differences.
+uint32_t Clock_ms( ) ;
@@ -20,6 +20,119 @@
 // Commenting the next line will enable fast distro settings
 //#define EMU
 
+// Uncommenting the next line will draw the non antialiased frames straight into the frame buffer, instead of through the
+// SDK graphics calls.
+//#define RASTER
+
+// Uncommenting the next line will re-space the grid lines every frame, narrower towards the cam and on steep crests.
+// Not at equal cost: with the interactive orbiting cam, it takes ~300 Q_sqrt and ~200 Q_div more per frame (anchored).
+//#define LOD
+
+// Uncommenting the next line will compute full frames only every KEYFRAME_TICKS simulation steps, interpolating between.
+//#define KEYFRAMES
+
+// Uncommenting the next line will pixel-diff the frame buffer rasterizer against the SDK graphics calls on every frame.
+//#define RASTER_CHECK
+
+// Uncommenting the next line will time the frame stages and draw patterns, hold SELECT 1.5 s to log the percentiles.
+//#define PROFILE
+
+// Uncommenting the next line will time them in CPU cycles (DWT cycle counter) instead of milliseconds. Needs access to
+// the Cortex-M debug registers, which the watch firmware denies to apps: for emulators or development firmwares only.
+//#define PROFILE_DWT
+
+// Uncommenting the next line will count the hot path work of every frame: f_XY evaluations, Q_div/Q_sqrt calls, probes
+// per occlusion test, terminator steps and segments drawn (logged per frame with LOG).
+//#define COUNTERS
+
+// Uncommenting the next line will add a step after the light to the UP click colorization cycle, overlaying the lattice
+// colored by the occlusion probes each vertex took (color platforms only, implies COUNTERS).
+//#define HEATMAP
+
+// Uncommenting the next line will send per frame stage timings and work counters to the phone, collected as CSV by
+// src/pkjs/telemetry.js (implies PROFILE and COUNTERS).
+//#define TELEMETRY
+
+// Uncommenting the next line will record the accelerometer samples, clicks and simulation steps of every frame into
+// persistent storage, until the trace is full or the app exits.
+//#define TRACE_RECORD
+
+// Uncommenting the next line will replay the recorded trace instead of the accelerometer and the buttons, frame by frame.
+//#define TRACE_REPLAY
+
+// Uncommenting the next line will time camera_update( ) over 256 calls at start and log its cost per call (implies LOG).
+// No watch or emulator figure has been recorded yet: the tools/host clock does not advance and logs 0 us.
+//#define CAMERA_MEASURE
+
+// Uncommenting the next line will log the static arrays, the heap around every allocation and the stack high-water.
+//#define MEMORY
+
+// Uncommenting the next line will run every Pattern x Transparency x Oscillator x Colorization scenario in turn, each
+// replaying the stored TRACE_RECORD trace from its start (looped), logging one JSON line of stage timings, work counts and
+// heap per scenario for tools/bench_compare.py (interactive build, implies TRACE_REPLAY, PROFILE and COUNTERS).
+//#define BENCH
+
+// Uncommenting the next line will check the fixed point distances, heights, projections and visibility against a double
+// precision reference every few frames, logging their max and mean errors (slow soft float: emulator or host runs, see
+// tools/host/build.sh; the wscript skips its soft-float check for such builds).
+//#define PRECISION
+
+// Uncommenting the next line will render every Pattern x Transparency x Colorization scenario of the GIF mode from the
+// same start, logging the frame buffer at fixed update counts for tools/golden_compare.py (needs GIF).
+//#define GOLDEN
+
+// Uncommenting the next line will run the GOLDEN scenarios last to first: their frames must not depend on the order, see
+// tools/host/golden_order.sh (implies GOLDEN).
+//#define GOLDEN_REVERSED
+
+#if defined(RASTER_CHECK)  &&  !defined(RASTER)
+  #define RASTER
+#endif
+
+#if defined(CAMERA_MEASURE)  &&  !defined(LOG)
+  #define LOG
+#endif
+
+#if defined(HEATMAP)  &&  !defined(PBL_COLOR)
+  #undef HEATMAP
+#endif
+
+#if defined(BENCH)  &&  defined(GIF)
+  #undef GIF
+#endif
+
+#if (defined(HEATMAP)  ||  defined(TELEMETRY)  ||  defined(BENCH))  &&  !defined(COUNTERS)
+  #define COUNTERS
+#endif
+
+#if (defined(TELEMETRY)  ||  defined(BENCH))  &&  !defined(PROFILE)
+  #define PROFILE
+#endif
+
+#if defined(TRACE_RECORD)  &&  defined(TRACE_REPLAY)
+  #error "TRACE_RECORD and TRACE_REPLAY are exclusive."
+#endif
+
+#if defined(BENCH)  &&  !defined(TRACE_REPLAY)
+  #define TRACE_REPLAY
+#endif
+
+#if defined(GOLDEN_REVERSED)  &&  !defined(GOLDEN)
+  #define GOLDEN
+#endif
+
+#if defined(GOLDEN)  &&  !defined(GIF)
+  #error "GOLDEN renders the deterministic GIF mode: needs GIF, not with BENCH."
+#endif
+
+#if defined(PRECISION)  &&  defined(KEYFRAMES)
+  #error "PRECISION checks full frames: not with KEYFRAMES."
+#endif
+
+#if defined(BENCH)  &&  (defined(TELEMETRY)  ||  defined(TRACE_RECORD))
+  #error "BENCH replays the stored trace and takes the frame timings: not with TELEMETRY or TRACE_RECORD."
+#endif
+
 // Uncoment next line to use BASALT to "fake" running on APLITE/DIORITE B&W platforms with antialising on ;-)
 //#undef PBL_COLOR
 
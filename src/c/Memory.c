@@ -0,0 +1,85 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Memory.c
+   Notes   : Heap marks and stack high-water measurement, logged with the platform name.
+           : Everything compiles away unless MEMORY is defined in Config.h.
+*/
+
+#include "Memory.h"
+#include "main.h"
+
+#ifdef MEMORY
+
+#define MEMORY_STACK_PATTERN        0x5AA5C33Cu
+#define MEMORY_STACK_WORDS          (MEMORY_STACK_PAINT_BYTES / sizeof(uint32_t))
+#define MEMORY_STACK_MARGIN_WORDS   16
+
+static volatile uint32_t *s_memory_stackTop ;       // Highest painted word, the stack grows down from there.
+static size_t             s_memory_heapUsed ;       // At the previous mark.
+static size_t             s_memory_heapFreeMin = SIZE_MAX ;
+
+
+// Not inlined, so that its frame sits just below main( )'s and the painted words below both.
+__attribute__((noinline))
+void
+Memory_stack_paint
+( )
+{
+  volatile uint32_t here ;
+
+  // A few words of margin, whatever else of this frame lies below here.
+  s_memory_stackTop = (volatile uint32_t *)((uintptr_t)&here & ~(uintptr_t)3) - MEMORY_STACK_MARGIN_WORDS ;
+
+  for (size_t w = 0  ;  w < MEMORY_STACK_WORDS  ;  ++w)
+    s_memory_stackTop[-(int)w] = MEMORY_STACK_PATTERN ;
+
+  s_memory_heapUsed = heap_bytes_used( ) ;
+}
+
+
+void
+Memory_stack_report
+( )
+{
+  if (s_memory_stackTop == NULL)
+    return ;
+
+  // Untouched words, from the deepest painted one up.
+  size_t untouched = 0 ;
+
+  while (untouched < MEMORY_STACK_WORDS  &&  s_memory_stackTop[-(int)(MEMORY_STACK_WORDS - 1 - untouched)] == MEMORY_STACK_PATTERN)
+    ++untouched ;
+
+  APP_LOG( APP_LOG_LEVEL_INFO, "memory:: %s stack high-water %u bytes below main( )%s, %u of %u painted bytes untouched"
+         , MEMORY_PLATFORM
+         , (unsigned)((MEMORY_STACK_WORDS - untouched) * sizeof(uint32_t))
+         , (untouched == 0) ? " or more" : ""
+         , (unsigned)(untouched * sizeof(uint32_t))
+         , (unsigned)MEMORY_STACK_PAINT_BYTES
+         ) ;
+}
+
+
+void
+Memory_heap_mark
+( const char *label )
+{
+  const size_t used   = heap_bytes_used( ) ;
+  const size_t unused = heap_bytes_free( ) ;
+
+  if (unused < s_memory_heapFreeMin)
+    s_memory_heapFreeMin = unused ;
+
+  APP_LOG( APP_LOG_LEVEL_INFO, "memory:: %s heap after %s: %u used (%+d), %u free, %u free at least"
+         , MEMORY_PLATFORM
+         , label
+         , (unsigned)used
+         , (int)used - (int)s_memory_heapUsed
+         , (unsigned)unused
+         , (unsigned)s_memory_heapFreeMin
+         ) ;
+
+  s_memory_heapUsed = used ;
+}
+
+#endif
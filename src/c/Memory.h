@@ -0,0 +1,44 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Memory.h
+   Notes   : Heap marks and stack high-water measurement, logged with the platform name.
+           : Everything compiles away unless MEMORY is defined in Config.h.
+*/
+
+#pragma once
+
+#include <pebble.h>
+#include "Config.h"
+
+
+// Platform name of the memory logs.
+#if defined(PBL_PLATFORM_APLITE)
+  #define MEMORY_PLATFORM   "aplite"
+#elif defined(PBL_PLATFORM_BASALT)
+  #define MEMORY_PLATFORM   "basalt"
+#elif defined(PBL_PLATFORM_CHALK)
+  #define MEMORY_PLATFORM   "chalk"
+#elif defined(PBL_PLATFORM_DIORITE)
+  #define MEMORY_PLATFORM   "diorite"
+#elif defined(PBL_PLATFORM_EMERY)
+  #define MEMORY_PLATFORM   "emery"
+#else
+  #define MEMORY_PLATFORM   "unknown"
+#endif
+
+
+#ifdef MEMORY
+  #define MEMORY_MARK(label)   Memory_heap_mark( label )
+#else
+  #define MEMORY_MARK(label)
+#endif
+
+
+// Fills MEMORY_STACK_PAINT_BYTES of the stack below the caller's frame with a known pattern. Call first thing in main( ).
+void Memory_stack_paint( ) ;
+
+// Logs how deep below main( ) the stack went: the painted bytes no longer holding the pattern.
+void Memory_stack_report( ) ;
+
+// Logs the heap used and free after the named allocation, the change since the previous mark and the lowest free so far.
+void Memory_heap_mark( const char *label ) ;
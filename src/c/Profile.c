@@ -0,0 +1,195 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Profile.c
+   Notes   : Scoped timers around the frame stages and draw patterns, aggregated into per stage log2 histograms.
+           : Everything compiles away unless PROFILE is defined in Config.h.
+*/
+
+#include "Profile.h"
+#include "main.h"
+#include "Clock.h"
+
+#ifdef PROFILE
+
+// Bin 0 counts samples of 0 ticks, bin b > 0 those of [2^(b-1), 2^b) ticks, the last bin everything above.
+#define PROFILE_BINS   26
+
+static const char *s_profile_stageNames[PROFILE_STAGES] = { "oscillator", "grid_z", "camera", "project", "visibility"
+                                                          , "draw_dots", "draw_lines", "draw_stripes", "draw_grid", "draw_rings"
+                                                          , "accel"
+                                                          } ;
+
+static uint16_t  s_profile_bins      [PROFILE_STAGES][PROFILE_BINS] ;   // Saturate at UINT16_MAX.
+static uint32_t  s_profile_count     [PROFILE_STAGES] ;
+static uint32_t  s_profile_ticksSum  [PROFILE_STAGES] ;
+static uint32_t  s_profile_ticksMax  [PROFILE_STAGES] ;
+static uint32_t  s_profile_frameTicks[PROFILE_STAGES] ;                 // Since the last Profile_frame_take( ).
+
+// Latest samples of all stages, the oldest overwritten first.
+static uint32_t  s_profile_ring     [PROFILE_RING_CAPACITY] ;
+static uint8_t   s_profile_ringStage[PROFILE_RING_CAPACITY] ;
+static int       s_profile_ringNum ;
+static int       s_profile_ringNext ;
+
+
+#ifdef PROFILE_DWT
+  // Cortex-M debug registers: trace enable (DEMCR), cycle counter enable (DWT_CTRL) and the cycle counter itself.
+  #define DEMCR        (*(volatile uint32_t *)0xE000EDFC)
+  #define DWT_CTRL     (*(volatile uint32_t *)0xE0001000)
+  #define DWT_CYCCNT   (*(volatile uint32_t *)0xE0001004)
+#endif
+
+
+inline
+static
+uint32_t
+profile_ticks
+( )
+{
+#ifdef PROFILE_DWT
+  return DWT_CYCCNT ;
+#else
+  return Clock_ms( ) ;
+#endif
+}
+
+
+inline
+static
+int
+profile_bin
+( const uint32_t ticks )
+{
+  const int bin = (ticks == 0) ? 0 : 32 - __builtin_clz( ticks ) ;
+
+  return (bin < PROFILE_BINS) ? bin : PROFILE_BINS - 1 ;
+}
+
+
+void
+Profile_initialize
+( )
+{
+#ifdef PROFILE_DWT
+  DEMCR     |= 1u << 24 ;   // TRCENA
+  DWT_CYCCNT = 0 ;
+  DWT_CTRL  |= 1u ;         // CYCCNTENA
+#endif
+}
+
+
+ProfileTimer
+Profile_start
+( const ProfileStage stage )
+{ return (ProfileTimer){ .start = profile_ticks( ), .stage = stage } ; }
+
+
+void
+Profile_stop
+( const ProfileTimer *timer )
+{
+  const uint32_t     ticks = profile_ticks( ) - timer->start ;
+  const ProfileStage stage = timer->stage ;
+  uint16_t          *bin   = &s_profile_bins[stage][profile_bin( ticks )] ;
+
+  if (*bin < UINT16_MAX)
+    ++*bin ;
+
+  ++s_profile_count[stage] ;
+  s_profile_ticksSum  [stage] += ticks ;
+  s_profile_frameTicks[stage] += ticks ;
+
+  if (ticks > s_profile_ticksMax[stage])
+    s_profile_ticksMax[stage] = ticks ;
+
+  s_profile_ring     [s_profile_ringNext] = ticks ;
+  s_profile_ringStage[s_profile_ringNext] = stage ;
+  s_profile_ringNext                      = (s_profile_ringNext + 1) % PROFILE_RING_CAPACITY ;
+
+  if (s_profile_ringNum < PROFILE_RING_CAPACITY)
+    ++s_profile_ringNum ;
+}
+
+
+void
+Profile_frame_take
+( uint32_t ticks[PROFILE_STAGES] )
+{
+  memcpy( ticks, s_profile_frameTicks, sizeof(s_profile_frameTicks) ) ;
+  memset( s_profile_frameTicks, 0, sizeof(s_profile_frameTicks) ) ;
+}
+
+
+// Upper bound of the bin holding the permille-th sample of the stage's histogram.
+static
+uint32_t
+profile_histogram_percentile
+( const ProfileStage stage
+, const int          permille
+)
+{
+  uint32_t total = 0 ;
+
+  for (int b = 0  ;  b < PROFILE_BINS  ;  ++b)
+    total += s_profile_bins[stage][b] ;
+
+  const uint32_t rank = (total * permille + 999) / 1000 ;
+  uint32_t       seen = 0 ;
+
+  for (int b = 0  ;  b < PROFILE_BINS - 1  ;  ++b)
+    if ((seen += s_profile_bins[stage][b]) >= rank)
+      return (b == 0) ? 0 : (1u << b) - 1 ;
+
+  return s_profile_ticksMax[stage] ;
+}
+
+
+void
+Profile_report
+( )
+{
+  uint32_t recent[PROFILE_RING_CAPACITY] ;
+
+  for (int stage = 0  ;  stage < PROFILE_STAGES  ;  ++stage)
+  {
+    if (s_profile_count[stage] == 0)
+      continue ;
+
+    APP_LOG( APP_LOG_LEVEL_INFO, "profile:: %s %u runs, mean %u, p50 %u, p90 %u, p99 %u, max %u %s"
+           , s_profile_stageNames[stage]
+           , (unsigned)s_profile_count[stage]
+           , (unsigned)(s_profile_ticksSum[stage] / s_profile_count[stage])
+           , (unsigned)profile_histogram_percentile( stage, 500 )
+           , (unsigned)profile_histogram_percentile( stage, 900 )
+           , (unsigned)profile_histogram_percentile( stage, 990 )
+           , (unsigned)s_profile_ticksMax[stage]
+           , PROFILE_TICKS_UNIT
+           ) ;
+
+    // The stage's samples still in the ring, insertion sorted.
+    int recentNum = 0 ;
+
+    for (int i = 0  ;  i < s_profile_ringNum  ;  ++i)
+      if (s_profile_ringStage[i] == stage)
+      {
+        int j = recentNum++ ;
+
+        for ( ;  j > 0  &&  recent[j-1] > s_profile_ring[i]  ;  --j)
+          recent[j] = recent[j-1] ;
+
+        recent[j] = s_profile_ring[i] ;
+      }
+
+    if (recentNum > 0)
+      APP_LOG( APP_LOG_LEVEL_INFO, "profile:: %s last %d runs, p50 %u, p90 %u, max %u %s"
+             , s_profile_stageNames[stage]
+             , recentNum
+             , (unsigned)recent[(recentNum - 1) * 50 / 100]
+             , (unsigned)recent[(recentNum - 1) * 90 / 100]
+             , (unsigned)recent[recentNum - 1]
+             , PROFILE_TICKS_UNIT
+             ) ;
+  }
+}
+
+#endif
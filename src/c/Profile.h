@@ -0,0 +1,69 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Profile.h
+   Notes   : Scoped timers around the frame stages and draw patterns, aggregated into per stage log2 histograms.
+           : Everything compiles away unless PROFILE is defined in Config.h.
+*/
+
+#pragma once
+
+#include <pebble.h>
+#include "Config.h"
+
+
+// Timed stages, one draw stage per defined Pattern, then the accelerometer handler (outside the frames).
+typedef enum { PROFILE_OSCILLATOR
+             , PROFILE_GRID_Z
+             , PROFILE_CAMERA
+             , PROFILE_PROJECT
+             , PROFILE_VISIBILITY
+             , PROFILE_DRAW_DOTS
+             , PROFILE_DRAW_LINES
+             , PROFILE_DRAW_STRIPES
+             , PROFILE_DRAW_GRID
+             , PROFILE_DRAW_RINGS
+             , PROFILE_ACCEL
+             , PROFILE_STAGES
+             }
+ProfileStage ;
+
+
+#ifdef PROFILE_DWT
+  #define PROFILE_TICKS_UNIT   "cycles"
+#else
+  #define PROFILE_TICKS_UNIT   "ms"
+#endif
+
+
+typedef struct
+{
+  uint32_t      start ;     // Profile clock ticks.
+  ProfileStage  stage ;
+} ProfileTimer ;
+
+
+#ifdef PROFILE
+  // Times the rest of the enclosing block: the sample is taken when the block is left, whichever way it is left.
+  #define PROFILE_SCOPE(stage)         PROFILE_SCOPE_AT(stage, __LINE__)
+  #define PROFILE_SCOPE_AT(stage, l)   PROFILE_SCOPE_NAMED(stage, profile_timer_##l)
+  #define PROFILE_SCOPE_NAMED(stage, name)  \
+    const ProfileTimer name __attribute__((cleanup(Profile_stop), unused)) = Profile_start( stage )
+#else
+  #define PROFILE_SCOPE(stage)
+#endif
+
+
+// Starts the profile clock: the DWT cycle counter with PROFILE_DWT, time_ms( ) milliseconds otherwise.
+void Profile_initialize( ) ;
+
+ProfileTimer Profile_start( const ProfileStage stage ) ;
+
+// Accounts the ticks elapsed since the timer started to its stage.
+void Profile_stop( const ProfileTimer *timer ) ;
+
+// Ticks of each stage since the previous call, for per frame figures.
+void Profile_frame_take( uint32_t ticks[PROFILE_STAGES] ) ;
+
+// Logs count, mean and p50/p90/p99/max of each stage: over the whole run from the histograms (bin upper bounds), and
+// exactly over the most recent samples still in the ring buffer.
+void Profile_report( ) ;
@@ -0,0 +1,275 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Raster.c
+   Notes   : Direct frame buffer rasterizer for the non antialiased drawing paths.
+           : Captures the frame buffer once per frame instead of going through one SDK call per pixel/segment.
+*/
+
+#include "Raster.h"
+
+
+// Tallest frame buffer of all the supported platforms (CHALK).
+#define RASTER_ROWS_MAX   180
+
+static GContext *s_raster_gCtx        = NULL ;
+static GBitmap  *s_raster_frameBuffer = NULL ;
+static bool      s_raster_is1Bit ;
+static int       s_raster_w, s_raster_h ;
+
+// Row addresses and drawable columns, fetched once per frame. On CHALK each row has its own [min_x, max_x] range.
+static uint8_t  *s_raster_row     [RASTER_ROWS_MAX] ;
+static int16_t   s_raster_row_xMin[RASTER_ROWS_MAX] ;
+static int16_t   s_raster_row_xMax[RASTER_ROWS_MAX] ;
+
+
+bool
+Raster_begin
+( GContext *gCtx )
+{
+  if ((s_raster_frameBuffer = graphics_capture_frame_buffer( gCtx )) == NULL)
+    return false ;
+
+  s_raster_gCtx = gCtx ;
+
+  const GRect bounds = gbitmap_get_bounds( s_raster_frameBuffer ) ;
+
+  s_raster_is1Bit = (gbitmap_get_format( s_raster_frameBuffer ) == GBitmapFormat1Bit) ;
+  s_raster_w      = bounds.size.w ;
+  s_raster_h      = (bounds.size.h < RASTER_ROWS_MAX) ? bounds.size.h : RASTER_ROWS_MAX ;
+
+  for (int y = 0  ;  y < s_raster_h  ;  ++y)
+  {
+    const GBitmapDataRowInfo rowInfo = gbitmap_get_data_row_info( s_raster_frameBuffer, y ) ;
+
+    s_raster_row     [y] = rowInfo.data ;
+    s_raster_row_xMin[y] = rowInfo.min_x ;
+    s_raster_row_xMax[y] = rowInfo.max_x ;
+  }
+
+  return true ;
+}
+
+
+void
+Raster_end
+( )
+{
+  if (s_raster_frameBuffer == NULL)
+    return ;
+
+  graphics_release_frame_buffer( s_raster_gCtx, s_raster_frameBuffer ) ;
+
+  s_raster_frameBuffer = NULL ;
+  s_raster_gCtx        = NULL ;
+}
+
+
+GBitmap*
+Raster_frameBuffer
+( )
+{ return s_raster_frameBuffer ; }
+
+
+// Frame buffer byte for a given color: an ARGB8 pixel or, on 1 bit frame buffers, 8 pixels worth of black or white.
+inline
+static
+uint8_t
+raster_fill
+( const GColor color )
+{
+  if (s_raster_is1Bit)
+    return gcolor_equal( color, GColorWhite ) ? 0xFF : 0x00 ;
+  else
+    return color.argb ;
+}
+
+
+// Horizontal run of pixels [xa, xb] on row y, clipped to the row's drawable columns.
+inline
+static
+void
+raster_span
+( const int      y
+, int            xa
+, int            xb
+, const uint8_t  fill
+)
+{
+  if (y < 0  ||  y >= s_raster_h)
+    return ;
+
+  if (xa > xb)
+  {
+    const int swap = xa ;  xa = xb ;  xb = swap ;
+  }
+
+  if (xa < s_raster_row_xMin[y])  xa = s_raster_row_xMin[y] ;
+  if (xb > s_raster_row_xMax[y])  xb = s_raster_row_xMax[y] ;
+
+  if (xa > xb)
+    return ;
+
+  uint8_t *row = s_raster_row[y] ;
+
+  if (!s_raster_is1Bit)
+  {
+    memset( row + xa, fill, xb - xa + 1 ) ;
+    return ;
+  }
+
+  // 1 bit: leftmost pixel is the least significant bit of each byte.
+  for (int x = xa  ;  x <= xb  ;  )
+    if ((x & 7) == 0  &&  x + 7 <= xb)
+    {
+      row[x >> 3] = fill ;
+      x += 8 ;
+    }
+    else
+    {
+      const uint8_t mask = 1 << (x & 7) ;
+
+      row[x >> 3] = (row[x >> 3] & ~mask) | (fill & mask) ;
+      ++x ;
+    }
+}
+
+
+void
+Raster_pixel
+( const int     x
+, const int     y
+, const GColor  color
+)
+{ raster_span( y, x, x, raster_fill( color ) ) ; }
+
+
+// Offset along the minor axis of the line's t-th pixel: t * dm / dM, rounded half away from the start (Bresenham).
+inline
+static
+int
+raster_minorOffset
+( const int64_t  t
+, const int      dm
+, const int      dM
+)
+{ return (int)((2 * t * dm + dM) / (2 * dM)) ; }
+
+
+void
+Raster_line
+( const int     x0
+, const int     y0
+, const int     x1
+, const int     y1
+, const GColor  color
+, const ink_t   ink
+)
+{
+  // Steps along the major axis, one pixel per step: t in [0, dM], the minor axis offset from raster_minorOffset( ).
+  const bool  isXmajor = abs( x1 - x0 ) >= abs( y1 - y0 ) ;
+  const int   M0       = isXmajor ? x0 : y0 ;
+  const int   m0       = isXmajor ? y0 : x0 ;
+  const int   dM       = abs( isXmajor ? x1 - x0 : y1 - y0 ) ;
+  const int   dm       = abs( isXmajor ? y1 - y0 : x1 - x0 ) ;
+  const int   sM       = ((isXmajor ? x1 - x0 : y1 - y0) >= 0) ? 1 : -1 ;
+  const int   sm       = ((isXmajor ? y1 - y0 : x1 - x0) >= 0) ? 1 : -1 ;
+  const int   MLast    = (isXmajor ? s_raster_w : s_raster_h) - 1 ;
+  const int   mLast    = (isXmajor ? s_raster_h : s_raster_w) - 1 ;
+
+  // Clip the steps to the major axis bounds.
+  int tA = (sM > 0) ? -M0 : M0 - MLast ;
+  int tB = (sM > 0) ? MLast - M0 : M0 ;
+
+  if (tA < 0 )  tA = 0 ;
+  if (tB > dM)  tB = dM ;
+
+  // Clip them to the minor axis bounds: offsets in [offA, offB], the offset never decreasing along the line.
+  const int offA = (sm > 0) ? -m0 : m0 - mLast ;
+  const int offB = (sm > 0) ? mLast - m0 : m0 ;
+
+  if (offB < 0  ||  offA > dm)
+    return ;
+
+  if (dm > 0)
+  {
+    // First step whose offset reaches offA, last one whose offset does not pass offB.
+    if (offA > 0)
+    {
+      const int t = (int)(((int64_t)(2 * offA - 1) * dM + 2 * dm - 1) / (2 * dm)) ;
+
+      if (t > tA)  tA = t ;
+    }
+
+    if (offB < dm)
+    {
+      const int t = (int)(((int64_t)(2 * offB + 1) * dM + 2 * dm - 1) / (2 * dm)) - 1 ;
+
+      if (t < tB)  tB = t ;
+    }
+  }
+
+  if (tA > tB)
+    return ;
+
+  const uint8_t fill = raster_fill( color ) ;
+
+  if (dM == 0)
+  {
+    raster_span( y0, x0, x0, fill ) ;
+    return ;
+  }
+
+  // Bresenham from the first visible step: rem is the rounding remainder of the offset, in [0, 2 * dM).
+  int M   = M0 + sM * tA ;
+  int off = raster_minorOffset( tA, dm, dM ) ;
+  int rem = (int)(2 * (int64_t)tA * dm + dM - 2 * (int64_t)off * dM) ;
+  int dot = tA % 3 ;                                      // Dotted: one every 3 pixels along the unclipped line.
+  int spanY = -1, spanX0 = 0, spanX1 = 0 ;                // Solid: same row pixels merged into a single span.
+
+  for (int t = tA  ;  t <= tB  ;  ++t)
+  {
+    const int m = m0 + sm * off ;
+    const int x = isXmajor ? M : m ;
+    const int y = isXmajor ? m : M ;
+
+    if (ink != INK100)
+    {
+      if (dot == 0)
+        raster_span( y, x, x, fill ) ;
+
+      dot = (dot == 2) ? 0 : dot + 1 ;
+    }
+    else if (y == spanY)
+      spanX1 = x ;
+    else
+    {
+      raster_span( spanY, spanX0, spanX1, fill ) ;      // Row -1 the first time: nothing drawn.
+      spanY = y ;  spanX0 = spanX1 = x ;
+    }
+
+    M   += sM ;
+    rem += 2 * dm ;
+
+    if (rem >= 2 * dM)
+    {
+      rem -= 2 * dM ;
+      ++off ;
+    }
+  }
+
+  if (ink == INK100)
+    raster_span( spanY, spanX0, spanX1, fill ) ;
+}
+
+
+void
+Raster_polyline
+( const GPoint *points
+, const int     pointsNum
+, const GColor  color
+, const ink_t   ink
+)
+{
+  for (int p = 1  ;  p < pointsNum  ;  ++p)
+    Raster_line( points[p-1].x, points[p-1].y, points[p].x, points[p].y, color, ink ) ;
+}
@@ -0,0 +1,52 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Raster.h
+   Notes   : Direct frame buffer rasterizer for the non antialiased drawing paths.
+           : Captures the frame buffer once per frame instead of going through one SDK call per pixel/segment.
+*/
+
+#pragma once
+
+#include <pebble.h>
+#include <karambola/Draw2D.h>
+
+
+// Captures the frame buffer. Must be paired with a call to Raster_end( ) before the update proc returns.
+bool Raster_begin( GContext *gCtx ) ;
+
+// Releases the captured frame buffer back to the graphics context.
+void Raster_end( ) ;
+
+// Frame buffer captured by Raster_begin( ), NULL outside of a Raster_begin( ) / Raster_end( ) pair.
+GBitmap* Raster_frameBuffer( ) ;
+
+void
+Raster_pixel
+( const int     x
+, const int     y
+, const GColor  color
+) ;
+
+// Integer Bresenham line. Clipped to the frame buffer bounds (RASTER_ROWS_MAX rows at most) before stepping, so only
+// the visible pixels are walked, then to the round display mask on CHALK.
+// INK100 draws a solid line, lower inks a dotted one: one pixel every 3 steps along the unclipped line. Not checked
+// against Draw2D_line_pattern( )'s pattern, RASTER_CHECK diffs the two on the emulator or a watch.
+void
+Raster_line
+( const int     x0
+, const int     y0
+, const int     x1
+, const int     y1
+, const GColor  color
+, const ink_t   ink
+) ;
+
+
+// Open polyline through pointsNum points, same as Raster_line( ) on each consecutive pair.
+void
+Raster_polyline
+( const GPoint *points
+, const int     pointsNum
+, const GColor  color
+, const ink_t   ink
+) ;
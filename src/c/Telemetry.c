@@ -0,0 +1,113 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Telemetry.c
+   Notes   : Per frame stage timings and work counters, batched and sent to the phone at most once per second.
+           : Everything compiles away unless TELEMETRY is defined in Config.h, src/pkjs/telemetry.js decodes the batches.
+*/
+
+#include "Telemetry.h"
+#include "main.h"
+#include "Clock.h"
+
+#ifdef TELEMETRY
+
+#define TELEMETRY_RECORD_BYTES   (TELEMETRY_FIELDS * sizeof(uint16_t))
+#define TELEMETRY_BATCH_BYTES    (TELEMETRY_BATCH_FRAMES * TELEMETRY_RECORD_BYTES)
+
+static uint8_t   s_telemetry_batch[TELEMETRY_BATCH_BYTES] ;
+static int       s_telemetry_framesNum ;
+static int       s_telemetry_droppedNum ;     // Since the last batch sent.
+static bool      s_telemetry_isInFlight ;
+static uint32_t  s_telemetry_sentMs ;
+
+
+static
+void
+telemetry_outbox_sent
+( DictionaryIterator *iterator
+, void               *context
+)
+{ s_telemetry_isInFlight = false ; }
+
+
+// The batch is lost, the next one goes out at the next interval.
+static
+void
+telemetry_outbox_failed
+( DictionaryIterator *iterator
+, AppMessageResult    reason
+, void               *context
+)
+{
+  s_telemetry_isInFlight = false ;
+
+  LOGW( "telemetry:: batch failed, reason %d", (int)reason ) ;
+}
+
+
+void
+Telemetry_start
+( )
+{
+  app_message_register_outbox_sent  ( telemetry_outbox_sent   ) ;
+  app_message_register_outbox_failed( telemetry_outbox_failed ) ;
+
+  // Fields count, dropped frames count and the batch.
+  app_message_open( 64, dict_calc_buffer_size( 3, sizeof(uint8_t), sizeof(uint16_t), TELEMETRY_BATCH_BYTES ) ) ;
+
+  s_telemetry_sentMs = Clock_ms( ) ;
+}
+
+
+static
+void
+telemetry_send
+( )
+{
+  DictionaryIterator *iterator ;
+
+  if (app_message_outbox_begin( &iterator ) != APP_MSG_OK)
+    return ;
+
+  dict_write_uint8 ( iterator, MESSAGE_KEY_TelemetryFields , TELEMETRY_FIELDS ) ;
+  dict_write_uint16( iterator, MESSAGE_KEY_TelemetryDropped, (s_telemetry_droppedNum < UINT16_MAX) ? s_telemetry_droppedNum : UINT16_MAX ) ;
+  dict_write_data  ( iterator, MESSAGE_KEY_TelemetryFrames , s_telemetry_batch, s_telemetry_framesNum * TELEMETRY_RECORD_BYTES ) ;
+
+  if (app_message_outbox_send( ) != APP_MSG_OK)
+    return ;
+
+  s_telemetry_isInFlight = true ;
+  s_telemetry_framesNum  = s_telemetry_droppedNum = 0 ;
+}
+
+
+void
+Telemetry_frame
+( const uint32_t fields[TELEMETRY_FIELDS] )
+{
+  // The batch sent was copied into the outbox, the next one fills up meanwhile.
+  if (s_telemetry_framesNum == TELEMETRY_BATCH_FRAMES)
+    ++s_telemetry_droppedNum ;
+  else
+  {
+    uint8_t *record = s_telemetry_batch + s_telemetry_framesNum++ * TELEMETRY_RECORD_BYTES ;
+
+    for (int f = 0  ;  f < TELEMETRY_FIELDS  ;  ++f)
+    {
+      const uint16_t field = (fields[f] < UINT16_MAX) ? fields[f] : UINT16_MAX ;
+
+      *record++ = field & 0xFF ;
+      *record++ = field >> 8 ;
+    }
+  }
+
+  const uint32_t now = Clock_ms( ) ;
+
+  if (s_telemetry_isInFlight  ||  s_telemetry_framesNum == 0  ||  now - s_telemetry_sentMs < TELEMETRY_INTERVAL_MS)
+    return ;
+
+  s_telemetry_sentMs = now ;
+  telemetry_send( ) ;
+}
+
+#endif
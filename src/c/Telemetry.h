@@ -0,0 +1,39 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Telemetry.h
+   Notes   : Per frame stage timings and work counters, batched and sent to the phone at most once per second.
+           : Everything compiles away unless TELEMETRY is defined in Config.h, src/pkjs/telemetry.js decodes the batches.
+*/
+
+#pragma once
+
+#include <pebble.h>
+#include "Config.h"
+
+
+// Fields of a frame record, each a little endian uint16 (saturated). Same order as FIELDS in src/pkjs/telemetry.js.
+typedef enum { TELEMETRY_STEPS             // Simulation steps the frame advanced.
+             , TELEMETRY_OSCILLATOR        // Stage timings, profile clock ticks...
+             , TELEMETRY_GRID_Z
+             , TELEMETRY_CAMERA
+             , TELEMETRY_PROJECT
+             , TELEMETRY_VISIBILITY
+             , TELEMETRY_DRAW              // ... all draw patterns together.
+             , TELEMETRY_F_XY              // Work counters.
+             , TELEMETRY_Q_DIV
+             , TELEMETRY_Q_SQRT
+             , TELEMETRY_TESTS
+             , TELEMETRY_PROBES
+             , TELEMETRY_TERMINATOR_STEPS
+             , TELEMETRY_SEGMENTS
+             , TELEMETRY_FIELDS
+             }
+TelemetryField ;
+
+
+// Opens AppMessage with an outbox sized for a full batch.
+void Telemetry_start( ) ;
+
+// Appends a frame record to the batch, sends the batch once TELEMETRY_INTERVAL_MS passed since the last one and the
+// previous one was delivered. Frames past a full batch are only counted as dropped.
+void Telemetry_frame( const uint32_t fields[TELEMETRY_FIELDS] ) ;
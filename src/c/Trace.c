@@ -0,0 +1,289 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Trace.c
+   Notes   : Input record/replay: raw accelerometer samples, clicks and the simulation steps of every frame, kept as a
+           : compact byte stream in persistent storage. Compiles away unless TRACE_RECORD or TRACE_REPLAY is defined.
+*/
+
+#include "Trace.h"
+#include "main.h"
+#include "Clock.h"
+
+#if defined(TRACE_RECORD)  ||  defined(TRACE_REPLAY)
+
+//  Events, the type in the 2 high bits of their first byte:
+//    FRAME  00ssssss  dtLo dtHi                  s simulation steps, dt ms since the previous frame (saturated).
+//    ACCEL  01000000  xLo xHi yLo yHi zLo zHi    raw sample, mG.
+//    CLICK  10cccccc                             c click handler id.
+//    CHUNK  11kkkkkk                             the inputs next arrived after the frame's chunk k (saturated).
+//
+//  Inputs land between the chunks of a frame: they replay right before the chunk that followed them when recorded,
+//  CHUNK only written ahead of the first input past the frame's first chunk.
+
+#define TRACE_FRAME          0x00
+#define TRACE_ACCEL          0x40
+#define TRACE_CLICK_EVENT    0x80
+#define TRACE_CHUNK          0xC0
+#define TRACE_TYPE_MASK      0xC0
+
+static uint8_t   s_trace[TRACE_BYTES_MAX] ;
+static int       s_trace_bytesNum ;
+static int       s_trace_at ;               // Replay position.
+static int       s_trace_framesNum ;
+static bool      s_trace_isRecording ;
+static uint32_t  s_trace_frameMs ;          // Wall clock of the previous frame.
+static int       s_trace_chunk ;            // Chunk of the current frame, 0 the first.
+static int       s_trace_chunkMarked ;      // Chunk of the last CHUNK event recorded.
+
+
+inline
+static
+int16_t
+trace_int16
+( const uint8_t *at )
+{ return (int16_t)(at[0] | (at[1] << 8)) ; }
+
+
+// Appends an event, or saves the trace and stops recording once it no longer fits.
+static
+void
+trace_append
+( const uint8_t *event
+, const int      bytesNum
+)
+{
+  if (!s_trace_isRecording)
+    return ;
+
+  if (s_trace_bytesNum + bytesNum > TRACE_BYTES_MAX)
+  {
+    Trace_save( ) ;
+    return ;
+  }
+
+  memcpy( s_trace + s_trace_bytesNum, event, bytesNum ) ;
+  s_trace_bytesNum += bytesNum ;
+}
+
+
+// Appends an input event, behind the CHUNK event it needs.
+static
+void
+trace_append_input
+( const uint8_t *event
+, const int      bytesNum
+)
+{
+  if (s_trace_chunkMarked != s_trace_chunk)
+  {
+    s_trace_chunkMarked = s_trace_chunk ;
+    trace_append( (uint8_t[]){ TRACE_CHUNK | s_trace_chunk }, 1 ) ;
+  }
+
+  trace_append( event, bytesNum ) ;
+}
+
+
+void
+Trace_record_start
+( )
+{
+  s_trace_bytesNum    = s_trace_framesNum = 0 ;
+  s_trace_frameMs     = Clock_ms( ) ;
+  s_trace_isRecording = true ;
+
+  persist_delete( TRACE_PERSIST_KEY ) ;
+}
+
+
+void
+Trace_record_frame
+( const int stepsNum )
+{
+  const uint32_t now  = Clock_ms( ) ;
+  const uint32_t dtMs = (now - s_trace_frameMs < UINT16_MAX) ? now - s_trace_frameMs : UINT16_MAX ;
+
+  s_trace_frameMs = now ;
+  s_trace_chunk   = s_trace_chunkMarked = 0 ;
+
+  trace_append( (uint8_t[]){ TRACE_FRAME | (stepsNum & ~TRACE_TYPE_MASK), dtMs & 0xFF, dtMs >> 8 }, 3 ) ;
+
+  if (s_trace_isRecording)
+    ++s_trace_framesNum ;
+}
+
+
+void
+Trace_record_chunk
+( )
+{
+  if (s_trace_chunk < (uint8_t)~TRACE_TYPE_MASK)
+    ++s_trace_chunk ;
+}
+
+
+void
+Trace_record_accel
+( const AccelSample sample )
+{
+  trace_append_input( (uint8_t[]){ TRACE_ACCEL
+                                 , sample.x & 0xFF, (uint16_t)sample.x >> 8
+                                 , sample.y & 0xFF, (uint16_t)sample.y >> 8
+                                 , sample.z & 0xFF, (uint16_t)sample.z >> 8
+                                 }
+                    , 7
+                    ) ;
+}
+
+
+void
+Trace_record_click
+( const uint8_t click )
+{ trace_append_input( (uint8_t[]){ TRACE_CLICK_EVENT | (click & ~TRACE_TYPE_MASK) }, 1 ) ; }
+
+
+void
+Trace_save
+( )
+{
+  if (!s_trace_isRecording)
+    return ;
+
+  s_trace_isRecording = false ;
+
+  // Byte count first, then the bytes in chunks of the persistent storage maximum.
+  persist_write_int( TRACE_PERSIST_KEY, s_trace_bytesNum ) ;
+
+  for (int at = 0, key = TRACE_PERSIST_KEY + 1  ;  at < s_trace_bytesNum  ;  at += PERSIST_DATA_MAX_LENGTH, ++key)
+    persist_write_data( key, s_trace + at, (s_trace_bytesNum - at < PERSIST_DATA_MAX_LENGTH) ? s_trace_bytesNum - at : PERSIST_DATA_MAX_LENGTH ) ;
+
+  APP_LOG( APP_LOG_LEVEL_INFO, "trace:: recorded %d frames, %d bytes", s_trace_framesNum, s_trace_bytesNum ) ;
+
+#ifdef LOG
+  // Also in the logs as hex, for replays off the watch.
+  for (int at = 0  ;  at < s_trace_bytesNum  ;  at += 32)
+  {
+    char hex[2*32 + 1] ;
+    int  h = 0 ;
+
+    for (int b = at  ;  b < at + 32  &&  b < s_trace_bytesNum  ;  ++b, h += 2)
+      snprintf( hex + h, 3, "%02x", s_trace[b] ) ;
+
+    hex[h] = '\0' ;
+    LOGD( "trace:: %04x %s", at, hex ) ;
+  }
+#endif
+}
+
+
+bool
+Trace_load
+( )
+{
+  s_trace_bytesNum = s_trace_at = s_trace_framesNum = 0 ;
+
+  if (!persist_exists( TRACE_PERSIST_KEY ))
+  {
+    APP_LOG( APP_LOG_LEVEL_WARNING, "trace:: no trace recorded, nothing to replay" ) ;
+    return false ;
+  }
+
+  const int bytesNum = persist_read_int( TRACE_PERSIST_KEY ) ;
+
+  for (int at = 0, key = TRACE_PERSIST_KEY + 1  ;  at < bytesNum  &&  at < TRACE_BYTES_MAX  ;  at += PERSIST_DATA_MAX_LENGTH, ++key)
+    persist_read_data( key, s_trace + at, (bytesNum - at < PERSIST_DATA_MAX_LENGTH) ? bytesNum - at : PERSIST_DATA_MAX_LENGTH ) ;
+
+  s_trace_bytesNum = (bytesNum < TRACE_BYTES_MAX) ? bytesNum : TRACE_BYTES_MAX ;
+
+  APP_LOG( APP_LOG_LEVEL_INFO, "trace:: replaying %d bytes", s_trace_bytesNum ) ;
+  return true ;
+}
+
+
+void
+Trace_replay_rewind
+( )
+{ s_trace_at = s_trace_chunk = s_trace_framesNum = 0 ; }
+
+
+// Replays the inputs up to the next FRAME event, or to the first CHUNK event not yet due if untilChunk. Returns the
+// FRAME event if stopped at one, NULL otherwise.
+static
+const uint8_t*
+trace_replay
+( TraceClickHandler onClick
+, const bool        untilChunk
+)
+{
+  while (s_trace_at < s_trace_bytesNum)
+  {
+    const uint8_t *event = s_trace + s_trace_at ;
+
+    switch (event[0] & TRACE_TYPE_MASK)
+    {
+      case TRACE_FRAME:
+        if (s_trace_at + 3 > s_trace_bytesNum)
+          break ;
+
+      return event ;
+
+      case TRACE_CHUNK:
+        if (untilChunk  &&  (event[0] & ~TRACE_TYPE_MASK) >= s_trace_chunk)
+          return NULL ;
+
+        s_trace_at += 1 ;
+      continue ;
+
+      case TRACE_ACCEL:
+        if (s_trace_at + 7 > s_trace_bytesNum)
+          break ;
+
+        Accel_feed( (AccelSample){ .x = trace_int16( event + 1 ), .y = trace_int16( event + 3 ), .z = trace_int16( event + 5 ) } ) ;
+        s_trace_at += 7 ;
+      continue ;
+
+      case TRACE_CLICK_EVENT:
+        onClick( event[0] & ~TRACE_TYPE_MASK ) ;
+        s_trace_at += 1 ;
+      continue ;
+    }
+
+    // Truncated event: the trace ends there.
+    s_trace_at = s_trace_bytesNum ;
+  }
+
+  return NULL ;
+}
+
+
+int
+Trace_replay_frame
+( TraceClickHandler onClick )
+{
+  const uint8_t *frame = trace_replay( onClick, false ) ;
+
+  if (frame == NULL)
+    return -1 ;
+
+  s_trace_at   += 3 ;
+  s_trace_chunk = 0 ;
+  ++s_trace_framesNum ;
+
+  if (s_trace_at >= s_trace_bytesNum)
+    APP_LOG( APP_LOG_LEVEL_INFO, "trace:: replayed %d frames", s_trace_framesNum ) ;
+
+  return frame[0] & ~TRACE_TYPE_MASK ;
+}
+
+
+void
+Trace_replay_chunk
+( TraceClickHandler onClick )
+{
+  if (s_trace_chunk < (uint8_t)~TRACE_TYPE_MASK)
+    ++s_trace_chunk ;
+
+  trace_replay( onClick, true ) ;
+}
+
+#endif
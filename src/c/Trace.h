@@ -0,0 +1,52 @@
+/*
+   WatchApp: Ripples 3D
+   File    : Trace.h
+   Notes   : Input record/replay: raw accelerometer samples, clicks and the simulation steps of every frame, kept as a
+           : compact byte stream in persistent storage. Compiles away unless TRACE_RECORD or TRACE_REPLAY is defined.
+*/
+
+#pragma once
+
+#include <pebble.h>
+#include "Config.h"
+#include "Accel.h"
+
+
+#ifdef TRACE_RECORD
+  #define TRACE_CLICK(click)   Trace_record_click( click )
+#else
+  #define TRACE_CLICK(click)
+#endif
+
+
+typedef void (*TraceClickHandler)( const uint8_t click ) ;
+
+
+// Starts a new trace, dropping the stored one.
+void Trace_record_start( ) ;
+
+// A frame about to advance stepsNum simulation steps: closes the inputs that arrived since the previous frame.
+void Trace_record_frame( const int stepsNum ) ;
+
+// Any further chunk of the frame about to run.
+void Trace_record_chunk( ) ;
+
+void Trace_record_accel( const AccelSample sample ) ;
+
+void Trace_record_click( const uint8_t click ) ;
+
+// Writes the trace to persistent storage, recording stops there.
+void Trace_save( ) ;
+
+// Reads the stored trace back for replay. Returns false if there is none.
+bool Trace_load( ) ;
+
+// Replays from the start of the loaded trace again.
+void Trace_replay_rewind( ) ;
+
+// Replays the inputs recorded ahead of the next frame: accelerometer samples to Accel_feed( ), clicks to onClick.
+// Returns the frame's simulation steps, -1 once past the end of the trace.
+int Trace_replay_frame( TraceClickHandler onClick ) ;
+
+// Replays the inputs recorded ahead of the frame's next chunk.
+void Trace_replay_chunk( TraceClickHandler onClick ) ;
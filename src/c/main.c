@@ -12,12 +12,67 @@
 #include <karambola/Q2.h>
 #include <karambola/Q3.h>
 #include <karambola/CamQ3.h>
-#include <karambola/Sampler.h>
 #include <karambola/Draw2D.h>
 
 #include "main.h"
 #include "Config.h"
 #include "types.h"
+#include "Raster.h"
+#include "Accel.h"
+#include "Profile.h"
+#include "Memory.h"
+#include "Telemetry.h"
+#include "Trace.h"
+#include "Clock.h"
+
+#ifdef PRECISION
+  #include <math.h>
+
+  #ifndef M_PI
+    #define M_PI   3.14159265358979323846
+  #endif
+#endif
+
+
+#ifdef COUNTERS
+  // Per frame hot path work, see work_stats_report( ).
+  static int  s_work_fXYNum ;
+  static int  s_work_divNum ;
+  static int  s_work_sqrtNum ;
+  static int  s_work_testsNum ;            // function_isVisible_fromPoint( ) calls...
+  static int  s_work_probesNum ;           // ... and their probes.
+  static int  s_work_terminatorStepsNum ;
+  static int  s_work_segmentsNum ;
+
+  #define WORK_COUNT(counter)   (++(counter))
+
+  inline
+  static
+  Q
+  work_div
+  ( const Q a, const Q b )
+  {
+    ++s_work_divNum ;
+    return Q_div( a, b ) ;
+  }
+
+
+  inline
+  static
+  Q
+  work_sqrt
+  ( const Q a )
+  {
+    ++s_work_sqrtNum ;
+    return Q_sqrt( a ) ;
+  }
+
+  // Every fixed point division and square root past this point is counted, not those inside karambola.
+  #define Q_div(a, b)   work_div( a, b )
+  #define Q_sqrt(a)     work_sqrt( a )
+#else
+  #define WORK_COUNT(counter)
+#endif
 
 
 // UI related
@@ -34,6 +89,9 @@ static Colorization  s_colorization = COLORIZATION_UNDEFINED ;
 static Pattern       s_pattern      = PATTERN_UNDEFINED ;
 static Oscilator     s_oscillator   = OSCILLATOR_UNDEFINED ;
 static Transparency  s_transparency = TRANSPARENCY_UNDEFINED ;
+#ifdef HEATMAP
+static bool          s_heatmap_isOn = false ;
+#endif
 
 static Q             world_xMin, world_xMax, world_yMin, world_yMax, world_zMin, world_zMax ;
 
@@ -58,19 +116,235 @@ world_boxing( Q3 p )
 #define Z_SHIFT      9
 #define DIST_SHIFT   4
 
-static int16_t    grid_major_x         [GRID_LINES] ;                   // S3.12  Coords [-7.999,+7.999]
-static int16_t    grid_major_y         [GRID_LINES] ;                   // S3.12  Coords [-7.999,+7.999]
-static int8_t     grid_major_z         [GRID_LINES][GRID_LINES] ;       // S0.7   f(x,y) [-0.99, +0.99]
-static uint16_t   grid_major_dist2osc  [GRID_LINES][GRID_LINES] ;       // U4.12  Need integer part up to 11.3137 because of max diagonal distance for bouncing oscillator.
-static Visibility grid_major_visibility[GRID_LINES][GRID_LINES] ;
-static GPoint     grid_major_screen    [GRID_LINES][GRID_LINES] ;
+#ifdef PBL_COLOR
+  #define PALETTE_BITS   3   // 8 colors.
+#else
+  #define PALETTE_BITS   1   // 2 inks.
+#endif
+
+//  Per vertex palette index, precomputed at update time, stored as one bit plane per index bit.
+//  Visibility is stored the same way, one bit plane per VisibilityPlane.
+//  A bit plane row is made of words uint32_t, bit j of the row is bit (j % 32) of word (j / 32).
+
+#define GRID_WORDS_MAX  ((GRID_LINES_MAX + 31) >> 5)
+
+#if defined(PBL_COLOR)  &&  SPOKES_NUM > 32
+  #error "Ring bit plane rows are a single uint32_t word."
+#endif
+
+#define ROW_MASK(n)  ((n) >= 32 ? ~0u : ((1u << (n)) - 1))
+
+#ifdef GRID_COMPACT
+  // Screen points stored as 8 bit offsets from the screen center, SCREEN_OFFSET_NONE if out of range (re-projected on load).
+  typedef ScreenOffset  ScreenStore ;
+  #define SCREEN_OFFSET_NONE   INT8_MIN
+#else
+  typedef GPoint        ScreenStore ;
+#endif
+
+//  Quincunx lattice: the n x n major grid and the (n-1) x (n-1) minor grid (centers of the major cells) together form
+//  one checkerboard of (2n-1) x (2n-1) half occupied cells. Lattice row r holds the points at the columns c of the same
+//  parity: the n major points of a major line for r even, the n-1 minor points of a minor line for r odd.
+//  Rows are stored by parity, the n major rows then (only while displayed) the n-1 minor rows, heap allocated as a
+//  single block sized at run time.
+typedef struct
+{
+  int          lines ;        // Major lines n, the lattice has 2n-1 rows and columns.
+  LatticeView  parities ;     // Row parities allocated.
+  int          words ;        // Words per bit plane row.
+  uint32_t    *visibility ;   // [rows][VISIBILITY_PLANES][words]
+  uint32_t    *palette ;      // [rows][PALETTE_BITS][words]
+  ScreenStore *screen ;       // [points]
+  uint16_t    *dist2osc ;     // [points]  U4.12  Need integer part up to 11.3137 because of max diagonal distance for bouncing oscillator.
+  int16_t     *xCoord ;       // [2n-1]    S3.12  Coords [-7.999,+7.999] of the lattice rows, minor lines halfway between major lines.
+  int16_t     *yCoord ;       // [2n-1]    S3.12  Coords of the lattice columns, the same table as xCoord unless LOD re-spaces each axis.
+  int8_t      *z ;            // [points]  S0.7   f(x,y) [-0.99, +0.99]
+#ifdef KEYFRAMES
+  int8_t      *zKey ;         // [points]  S0.7   z of the last keyframe.
+  int8_t      *zNext ;        // [points]  S0.7   z of the next keyframe, KEYFRAME_TICKS ahead.
+#endif
+#ifdef HEATMAP
+  uint8_t     *probes ;       // [points]  Occlusion probes of the vertex's last visibility update, cam and light.
+#endif
+} Lattice ;
+
+#ifdef LOD
+  #define LATTICE_COORD_TABLES   2
+#else
+  #define LATTICE_COORD_TABLES   1
+#endif
+
+#ifdef KEYFRAMES
+  #define LATTICE_Z_TABLES       3
+#else
+  #define LATTICE_Z_TABLES       1
+#endif
+
+#ifdef HEATMAP
+  #define LATTICE_PROBE_TABLES   1
+#else
+  #define LATTICE_PROBE_TABLES   0
+#endif
+
+static int       s_grid_lines ;           // Major grid resolution, the minor grid has one line less.
+static Lattice  *s_lattice = NULL ;       // Minor rows only allocated while PATTERN_DOTS or PATTERN_STRIPES are displayed.
+static bool       s_grid_isProjected = false ;   // Screen points and culling up to date with the cam and the lattice z.
+
+
+// Points in lattice row r.
+inline
+static
+int
+Lattice_rowLength
+( const Lattice *l
+, const int      r
+)
+{ return l->lines - (r & 1) ; }
+
+
+// Storage index of lattice row r: major rows first, then minor rows.
+inline
+static
+int
+Lattice_rowSlot
+( const Lattice *l
+, const int      r
+)
+{ return (r & 1) * l->lines + (r >> 1) ; }
+
+
+// Storage index of point k of lattice row r.
+inline
+static
+int
+Lattice_point
+( const Lattice *l
+, const int      r
+, const int      k
+)
+{
+  return (r & 1) ? l->lines * l->lines + (r >> 1) * (l->lines - 1) + k
+                 : (r >> 1) * l->lines + k
+                 ;
+}
+
+
+// Lattice rows and columns: 2n-1 for n major lines.
+inline
+static
+int
+Lattice_size
+( const Lattice *l )
+{ return 2*l->lines - 1 ; }
+
+
+// Row (or column) index step of a view: every other one for the major rows only, all for the full lattice.
+inline
+static
+int
+Lattice_step
+( const LatticeView view )
+{ return (view == LATTICE_FULL) ? 1 : 2 ; }
+
+
+inline
+static
+uint32_t*
+Lattice_visibilityRow
+( const Lattice *l
+, const int      r
+)
+{ return l->visibility + Lattice_rowSlot( l, r ) * VISIBILITY_PLANES * l->words ; }
+
+
+inline
+static
+uint32_t*
+Lattice_paletteRow
+( const Lattice *l
+, const int      r
+)
+{ return l->palette + Lattice_rowSlot( l, r ) * PALETTE_BITS * l->words ; }
+
+
+inline
+static
+bool
+bits_get
+( const uint32_t *plane
+, const int       j
+)
+{ return (plane[j >> 5] >> (j & 31)) & 1 ; }
+
+
+inline
+static
+void
+bits_set
+( uint32_t   *plane
+, const int   j
+, const bool  bit
+)
+{
+  if (bit)
+    plane[j >> 5] |=  (1u << (j & 31)) ;
+  else
+    plane[j >> 5] &= ~(1u << (j & 31)) ;
+}
+
 
-static int16_t    grid_minor_x         [GRID_LINES-1] ;                 // S3.12  Coords [-7.999,+7.999]
-static int16_t    grid_minor_y         [GRID_LINES-1] ;                 // S3.12  Coords [-7.999,+7.999]
-static int8_t     grid_minor_z         [GRID_LINES-1][GRID_LINES-1] ;   // S0.7   f(x,y) [-0.99, +0.99]
-static uint16_t   grid_minor_dist2osc  [GRID_LINES-1][GRID_LINES-1] ;   // U4.12  Need integer part up to sqrt(2) * GRID_SCALE because of max diagonal distance for bouncing oscillator.
-static Visibility grid_minor_visibility[GRID_LINES-1][GRID_LINES-1] ;
-static GPoint     grid_minor_screen    [GRID_LINES-1][GRID_LINES-1] ;
+// Valid bits of word w in a bit plane row of n bits.
+inline
+static
+uint32_t
+bits_mask
+( const int n
+, const int w
+)
+{ return ROW_MASK(n - (w << 5)) ; }
+
+
+// Sets the first n bits of a bit plane row.
+inline
+static
+void
+bits_fill
+( uint32_t  *plane
+, const int  words
+, const int  n
+)
+{
+  for (int w = 0  ;  w < words  ;  ++w)
+    plane[w] = bits_mask( n, w ) ;
+}
+
+
+inline
+static
+bool
+bits_isZero
+( const uint32_t *plane
+, const int       words
+)
+{
+  for (int w = 0  ;  w < words  ;  ++w)
+    if (plane[w] != 0u)
+      return false ;
+
+  return true ;
+}
+
+#ifdef PBL_COLOR
+  // Polar mesh: ring k has radius (k+1) * rings_step around the oscillator, height only depends on the ring.
+  static Q          rings_step ;
+  static int        rings_num ;                                     // Rings with at least one vertex inside the world box.
+  static Q          spokes_cos         [SPOKES_NUM] ;
+  static Q          spokes_sin         [SPOKES_NUM] ;
+  static int8_t     rings_z            [RINGS_NUM] ;                // S0.7   f(r) [-0.99, +0.99]
+  static uint32_t   rings_visibility   [RINGS_NUM][VISIBILITY_PLANES] ;
+  static GPoint     rings_screen       [RINGS_NUM][SPOKES_NUM] ;
+  static uint32_t   rings_palette      [RINGS_NUM][PALETTE_BITS] ;
+#endif
 
 static int32_t oscillator_anglePhase ;
 static Q2      oscillator_position ;
@@ -79,6 +353,20 @@ static Q2      oscillator_acceleration ;   // For OSCILLATOR_BOUNCING
 
 static int        s_world_updateCount       = 0 ;
 static AppTimer  *s_world_updateTimer_ptr   = NULL ;
+static FrameStage s_frame_stage             = FRAME_STAGE_IDLE ;
+static int        s_frame_row               = 0 ;          // Next row (ring) of the current chunked stage.
+static uint8_t    s_frame_dirty             = 0 ;          // FrameDirty bits left for the frame under way.
+static bool       s_frame_isDrawable        = false ;      // Lattice state of a complete frame, no mode changed since.
+static bool       s_frame_isDrawDue         = false ;      // Complete frame not drawn yet, its world_draw( ) arms the next one.
+static bool       s_frame_isInChunk         = false ;      // In world_update_chunk( ), where trace replays click.
+static uint8_t   *s_frame_snapshot          = NULL ;       // Frame buffer bytes of the last complete frame drawn...
+static size_t     s_frame_snapshotBytes     = 0 ;          // ... and their count, once known.
+
+#ifdef KEYFRAMES
+  static int      s_keyframe_tick ;                  // Simulation step of the last keyframe.
+  static int32_t  s_keyframe_nextPhase ;             // Oscillator phase KEYFRAME_TICKS steps after it.
+  static bool     s_keyframe_isValid = false ;       // Lattice z, zKey and zNext computed for the current lattice.
+#endif
 
 
 /***  ---------------  Prototypes  ---------------  ***/
@@ -94,9 +382,23 @@ cam_config
 , const int32_t  rotXangle
 ) ;
 
-void grid_minor_dist2osc_update( ) ;
-void grid_minor_z_update( ) ;
-void grid_minor_visibility_update( ) ;
+void palette_set( ) ;
+void grid_palette_update( ) ;
+void grid_screen_project( const bool isUncoveredTested ) ;
+void world_update_timer_handler( void *data ) ;
+void frame_invalidate( const uint8_t dirty ) ;
+void frame_click( ) ;
+void frame_snapshot_free( ) ;
+void activity_wake( ) ;
+void activity_update( ) ;
+void activity_cpu( const int ms ) ;
+
+#ifdef PBL_COLOR
+  void rings_dist2osc_update( ) ;
+  void rings_z_update( ) ;
+  void rings_visibility_update( const int kFirst, const int kEnd ) ;
+  void rings_screen_project( ) ;
+#endif
 
 
 /***  ---------------  COLORIZATION  ---------------  ***/
@@ -109,6 +411,9 @@ colorization_set
     return ;
 
   s_colorization = colorization ;
+
+  palette_set( ) ;
+  frame_invalidate( FRAME_DIRTY_PALETTE ) ;
 }
 
 
@@ -132,6 +437,13 @@ colorization_change
     break ;
 
     case COLORIZATION_LIGHT:
+#ifdef HEATMAP
+      // One more step with the probes heatmap over the lit lattice.
+      s_heatmap_isOn = !s_heatmap_isOn ;
+
+      if (s_heatmap_isOn)
+        break ;
+#endif
       colorization_set( COLORIZATION_MONO ) ;
     break ;
 
@@ -139,8 +451,6 @@ colorization_change
       colorization_set( COLORIZATION_DEFAULT ) ;
     break ;
   } ;
-
-  layer_mark_dirty( s_world_layer ) ;
 }
 
 
@@ -149,11 +459,251 @@ colorization_change_click_handler
 ( ClickRecognizerRef recognizer
 , void              *context
 )
-{ colorization_change( ) ; }
+{ TRACE_CLICK( TRACE_CLICK_COLORIZATION ) ;  activity_wake( ) ;  colorization_change( ) ;  frame_click( ) ; }
 
 
 /***  ---------------  PATTERN  ---------------  ***/
 
+// Bytes kept free for the stack, layers and heap fragmentation when sizing the grids.
+#define GRID_MEMORY_RESERVE   2048
+
+
+// Heap bytes of a lattice of n major lines, with the minor rows for LATTICE_FULL.
+size_t
+Lattice_bytes
+( const int          lines
+, const LatticeView  parities
+)
+{
+  const int words  = (lines + 31) >> 5 ;
+  const int rows   = (parities == LATTICE_FULL) ? 2*lines - 1 : lines ;
+  const int points = lines * lines + ((parities == LATTICE_FULL) ? (lines-1) * (lines-1) : 0) ;
+
+  return sizeof(Lattice)
+       + rows * (VISIBILITY_PLANES + PALETTE_BITS) * words * sizeof(uint32_t)
+       + points * (sizeof(ScreenStore) + sizeof(uint16_t) + (LATTICE_Z_TABLES + LATTICE_PROBE_TABLES) * sizeof(int8_t))
+       + LATTICE_COORD_TABLES * (2*lines - 1) * sizeof(int16_t)
+       ;
+}
+
+
+// All lattice points visible from the cam (TRANSPARENCY_TRANSLUCENT).
+void
+Lattice_visibility_setAll
+( Lattice *l )
+{
+  for (int r = 0  ;  r < Lattice_size( l )  ;  r += Lattice_step( l->parities ))
+    bits_fill( Lattice_visibilityRow( l, r ) + VISIBILITY_FROM_CAM * l->words, l->words, Lattice_rowLength( l, r ) ) ;
+}
+
+
+// Single heap block lattice of n major lines, major lines evenly spaced across the world box.
+Lattice*
+Lattice_create
+( const int          lines
+, const LatticeView  parities
+)
+{
+  Lattice *l = calloc( 1, Lattice_bytes( lines, parities ) ) ;
+
+  if (l == NULL)
+  {
+    LOGE( "Lattice_create: %d lines, %u bytes, out of memory", lines, (unsigned)Lattice_bytes( lines, parities ) ) ;
+    return NULL ;
+  }
+
+  MEMORY_MARK( "Lattice_create( )" ) ;
+
+  const int rows   = (parities == LATTICE_FULL) ? 2*lines - 1 : lines ;
+  const int points = lines * lines + ((parities == LATTICE_FULL) ? (lines-1) * (lines-1) : 0) ;
+
+  // Arrays laid out by decreasing alignment.
+  l->lines      = lines ;
+  l->parities   = parities ;
+  l->words      = (lines + 31) >> 5 ;
+  l->visibility = (uint32_t *)(l + 1) ;
+  l->palette    = l->visibility + rows * VISIBILITY_PLANES * l->words ;
+  l->screen     = (ScreenStore *)(l->palette + rows * PALETTE_BITS * l->words) ;
+  l->dist2osc   = (uint16_t *)(l->screen + points) ;
+  l->xCoord     = (int16_t *)(l->dist2osc + points) ;
+  l->yCoord     = l->xCoord + (LATTICE_COORD_TABLES - 1) * (2*lines - 1) ;
+  l->z          = (int8_t *)(l->yCoord + 2*lines - 1) ;
+#ifdef KEYFRAMES
+  l->zKey       = l->z    + points ;
+  l->zNext      = l->zKey + points ;
+#endif
+#ifdef HEATMAP
+  l->probes     = (uint8_t *)(l->z + LATTICE_Z_TABLES * points) ;
+#endif
+
+  // Even lattice coords are the major lines, odd ones the minor lines half a cell further.
+  const Q distanceBetweenLines = Q_div( grid_scale, Q_from_int(lines - 1) ) ;
+  Q       lCoord ;
+  int     c ;
+
+  for (c = 0, lCoord = -grid_halfScale  ;  c < 2*lines - 1  ;  c += 2, lCoord += distanceBetweenLines)
+    l->xCoord[c] = l->yCoord[c] = lCoord >> COORD_SHIFT ;
+
+  for (c = 1, lCoord = -grid_halfScale + (distanceBetweenLines >> 1)  ;  c < 2*lines - 1  ;  c += 2, lCoord += distanceBetweenLines)
+    l->xCoord[c] = l->yCoord[c] = lCoord >> COORD_SHIFT ;
+
+  if (s_transparency == TRANSPARENCY_TRANSLUCENT)
+    Lattice_visibility_setAll( l ) ;
+
+  return l ;
+}
+
+
+Lattice*
+Lattice_destroy
+( Lattice *l )
+{
+  free( l ) ;
+  return NULL ;
+}
+
+
+// Largest major grid resolution whose full lattice the heap could hold, on top of what the lattice and the frame
+// snapshot, given up first, already use.
+int
+grid_lines_affordable
+( )
+{
+  const size_t used     = ((s_lattice != NULL) ? Lattice_bytes( s_lattice->lines, s_lattice->parities ) : 0)
+                        + ((s_frame_snapshot != NULL) ? s_frame_snapshotBytes : 0)
+                        ;
+  const size_t heapFree = heap_bytes_free( ) ;
+  const size_t budget   = (used + heapFree > GRID_MEMORY_RESERVE) ? used + heapFree - GRID_MEMORY_RESERVE : 0 ;
+
+  int lines = GRID_LINES_MIN ;
+
+  while (lines < GRID_LINES_MAX  &&  Lattice_bytes( lines+1, LATTICE_FULL ) <= budget)
+    ++lines ;
+
+  return lines ;
+}
+
+
+// Per array RAM accounting of the lattice storage, and how many grid lines the current RAM could afford.
+void
+grid_memory_report
+( )
+{
+#ifdef LOG
+  const Lattice *l = s_lattice ;
+
+  if (l != NULL)
+  {
+    const int rows   = (l->parities == LATTICE_FULL) ? 2*l->lines - 1 : l->lines ;
+    const int points = l->lines * l->lines + ((l->parities == LATTICE_FULL) ? (l->lines-1) * (l->lines-1) : 0) ;
+
+    LOGD( "grid_memory_report: %d lines, %d rows, visibility %u, palette %u, screen %u, dist2osc %u, coord %u, z %u bytes"
+        , l->lines
+        , rows
+        , (unsigned)(rows * VISIBILITY_PLANES * l->words * sizeof(uint32_t))
+        , (unsigned)(rows * PALETTE_BITS * l->words * sizeof(uint32_t))
+        , (unsigned)(points * sizeof(ScreenStore))
+        , (unsigned)(points * sizeof(uint16_t))
+        , (unsigned)(LATTICE_COORD_TABLES * (2*l->lines - 1) * sizeof(int16_t))
+        , (unsigned)(LATTICE_Z_TABLES * points * sizeof(int8_t))
+        ) ;
+  }
+
+  LOGD( "grid_memory_report: %u heap bytes free, up to %d lines affordable (max %d)"
+      , (unsigned)heap_bytes_free( ), grid_lines_affordable( ), GRID_LINES_MAX
+      ) ;
+#endif
+}
+
+
+// Lattice view (and so rows allocated) needed by a pattern.
+inline
+static
+LatticeView
+pattern_latticeView
+( const Pattern pattern )
+{ return (pattern == PATTERN_DOTS  ||  pattern == PATTERN_STRIPES) ? LATTICE_FULL : LATTICE_MAJOR ; }
+
+
+// (Re)allocates the lattice if its resolution or rows change. Falls back to coarser lattices if the heap turns out to be
+// more fragmented than estimated.
+bool
+lattice_set
+( int                lines
+, const LatticeView  parities
+)
+{
+  if (s_lattice != NULL  &&  s_lattice->lines == lines  &&  s_lattice->parities == parities)
+    return true ;
+
+  // The lattice has the heap first, the snapshot comes back with the next complete frame if it still fits.
+  frame_snapshot_free( ) ;
+  s_lattice = Lattice_destroy( s_lattice ) ;
+
+  for ( ;  ;  lines -= 2)
+  {
+    s_grid_lines = lines ;
+
+    if ((s_lattice = Lattice_create( lines, parities )) != NULL  ||  lines - 2 < GRID_LINES_MIN)
+      break ;
+  }
+
+  grid_memory_report( ) ;
+
+  return s_lattice != NULL ;
+}
+
+
+// Lattice for a pattern, falling back to PATTERN_LINES' major rows only. Returns the pattern the lattice can display:
+// PATTERN_UNDEFINED, that neither updates nor draws anything, when not even the coarsest major rows fit the heap and
+// s_lattice is left NULL. The polar mesh does not need the lattice.
+Pattern
+pattern_lattice_set
+( const int      lines
+, const Pattern  pattern
+)
+{
+  if (lattice_set( lines, pattern_latticeView( pattern ) )  ||  pattern == PATTERN_RINGS)
+    return pattern ;
+
+  if (lattice_set( lines, pattern_latticeView( PATTERN_LINES ) ))
+    return PATTERN_LINES ;
+
+  return PATTERN_UNDEFINED ;
+}
+
+
+// A mode changed: the lattice state is no complete frame's any more, world_draw( ) falls back on the last one drawn until
+// the frame under way (or the next one) recomputes the dirty arrays.
+void
+frame_invalidate
+( const uint8_t dirty )
+{
+  s_frame_dirty     |= dirty ;
+  s_frame_isDrawable = false ;
+}
+
+
+// The lattice or the cam changed outside the frame computation: screen points are stale, and a frame halfway through its
+// chunks restarts from its first row.
+void
+grid_projection_invalidate
+( )
+{
+  s_grid_isProjected = false ;
+
+  if (s_frame_stage != FRAME_STAGE_IDLE)
+  {
+    s_frame_stage = FRAME_STAGE_Z ;
+    s_frame_row   = 0 ;
+  }
+#ifdef KEYFRAMES
+  else
+    s_keyframe_isValid = false ;    // Nothing to interpolate from until the next keyframe.
+#endif
+}
+
+
 void
 pattern_set
 ( Pattern pattern )
@@ -161,18 +711,13 @@ pattern_set
   if (s_pattern == pattern)
     return ;
 
-  switch (s_pattern = pattern)
-  {
-    case PATTERN_DOTS:
-    case PATTERN_STRIPES:
-      grid_minor_dist2osc_update( ) ;
-      grid_minor_z_update( ) ;
-      grid_minor_visibility_update( ) ;
-    break ;
+  // The minor lattice rows only live while displayed.
+  s_pattern = pattern_lattice_set( s_grid_lines, pattern ) ;
 
-    default:
-      break ;
-  }
+  // Newly allocated rows, or the lattice not kept up to date while the polar mesh was being displayed: z and visibility
+  // by the frame restarted, palette indices of a pattern that was not being displayed may be from an older colorization.
+  frame_invalidate( FRAME_DIRTY_DIST2OSC | FRAME_DIRTY_PALETTE ) ;
+  grid_projection_invalidate( ) ;
 }
 
 
@@ -195,6 +740,10 @@ pattern_change
       break ;
 
       case PATTERN_GRID:
+        pattern_set( PBL_IF_COLOR_ELSE(PATTERN_RINGS, PATTERN_DOTS) ) ;
+      break ;
+
+      case PATTERN_RINGS:
         pattern_set( PATTERN_DOTS ) ;
       break ;
 
@@ -202,8 +751,6 @@ pattern_change
         pattern_set( PATTERN_DEFAULT ) ;
       break ;
   }
-
-  layer_mark_dirty( s_world_layer ) ;
 }
 
 
@@ -212,7 +759,7 @@ pattern_change_click_handler
 ( ClickRecognizerRef recognizer
 , void              *context
 )
-{ pattern_change( ) ; }
+{ TRACE_CLICK( TRACE_CLICK_PATTERN ) ;  activity_wake( ) ;  pattern_change( ) ;  frame_click( ) ; }
 
 
 /***  ---------------  TRANSPARENCY  ---------------  ***/
@@ -232,20 +779,24 @@ transparency_set
     break ;
 
     case TRANSPARENCY_TRANSLUCENT:
-      // Set all major to true.
-      for (int i = 0  ;  i < GRID_LINES  ;  ++i)
-        for (int j = 0  ;  j < GRID_LINES  ;  ++j)
-          grid_major_visibility[i][j].fromCam = true ;
-
-      // Set all minor to true.
-      for (int i = 0  ;  i < GRID_LINES-1  ;  ++i)
-        for (int j = 0  ;  j < GRID_LINES-1  ;  ++j)
-          grid_minor_visibility[i][j].fromCam = true ;
+      // Set all lattice points to true.
+      if (s_lattice != NULL)
+        Lattice_visibility_setAll( s_lattice ) ;
+
+    #ifdef PBL_COLOR
+      // Set all rings to true.
+      for (int k = 0  ;  k < RINGS_NUM  ;  ++k)
+        rings_visibility[k][VISIBILITY_FROM_CAM] = ROW_MASK(SPOKES_NUM) ;
+    #endif
     break ;
 
     case TRANSPARENCY_UNDEFINED:
     break ;
   } ;
+
+  // Visibility rows of the frame under way tested for the former transparency.
+  frame_invalidate( 0 ) ;
+  grid_projection_invalidate( ) ;
 }
 
 
@@ -272,8 +823,6 @@ transparency_change
       transparency_set( TRANSPARENCY_DEFAULT ) ;
     break ;
   } ;
-
-  layer_mark_dirty( s_world_layer ) ;
 }
 
 
@@ -282,7 +831,7 @@ transparency_change_click_handler
 ( ClickRecognizerRef recognizer
 , void              *context
 )
-{ transparency_change( ) ; }
+{ TRACE_CLICK( TRACE_CLICK_TRANSPARENCY ) ;  activity_wake( ) ;  transparency_change( ) ;  frame_click( ) ; }
 
 
 /***  ---------------  Camera related  ---------------  ***/
@@ -326,6 +875,8 @@ cam_initialize
 }
 
 
+// Set up afresh every frame, not cached per orbit step: interactively the view point follows the accelerometer, and
+// the one fixed orbit, GIF ANCHORED, repeats every 2048 steps, so GIF_STOP_COUNT ends the GIF before any step recurs.
 void
 cam_config
 ( const Q3       viewPoint
@@ -396,6 +947,18 @@ light_initialize
 
 static Q   screen_project_scale ;
 static Q2  screen_project_translate ;
+static GPoint screen_center ;
+
+// Drawable region, widened by SCREEN_CULL_MARGIN for antialiased strokes. The whole window: nothing is culled behind the
+// ActionBarLayer, the world layer is added after it and so drawn on top of it (see window_load( )).
+static GPoint screen_cullMin, screen_cullMax ;
+#ifdef PBL_ROUND
+  static int  screen_cullDiagonal ;   // |dx| + |dy| from the display center beyond which a point is outside the octagon around the display circle.
+#endif
+
+static int  s_cull_verticesNum ;      // Per frame culling stats.
+static int  s_cull_testsNum ;
+static int  s_cull_segmentsNum ;
 
 
 void
@@ -411,18 +974,121 @@ screen_project
 }
 
 
-/***  ---------------  OSCILLATOR MODE  ---------------  ***/
+// Outcode of a screen point against the drawable region: one bit per outer half plane it lies in, left, right, top,
+// bottom and on round displays the 4 diagonals of the octagon around the display circle. Segments whose end points share
+// a bit are entirely off screen.
+inline
+static
+uint8_t
+screen_outcode
+( const GPoint screen )
+{
+  uint8_t outcode = ((screen.x < screen_cullMin.x) ? 0x01 : 0)
+                  | ((screen.x > screen_cullMax.x) ? 0x02 : 0)
+                  | ((screen.y < screen_cullMin.y) ? 0x04 : 0)
+                  | ((screen.y > screen_cullMax.y) ? 0x08 : 0)
+                  ;
+
+#ifdef PBL_ROUND
+  const int dx = screen.x - screen_center.x ;
+  const int dy = screen.y - screen_center.y ;
+
+  outcode |= (( dx + dy > screen_cullDiagonal) ? 0x10 : 0)
+          |  (( dx - dy > screen_cullDiagonal) ? 0x20 : 0)
+          |  ((-dx + dy > screen_cullDiagonal) ? 0x40 : 0)
+          |  ((-dx - dy > screen_cullDiagonal) ? 0x80 : 0)
+          ;
+#endif
+
+  return outcode ;
+}
+
 
 void
-oscillatorMode_set
-( Oscilator pOscilator )
+cull_stats_report
+( )
 {
-  if (s_oscillator == pOscilator)
-    return ;
+  LOGD( "cull:: %d vertices culled, %d occlusion tests skipped, %d segments rejected"
+      , s_cull_verticesNum, s_cull_testsNum, s_cull_segmentsNum
+      ) ;
 
-  switch (s_oscillator = pOscilator)
-  {
-    case OSCILLATOR_FLOATING:
+  s_cull_verticesNum = s_cull_testsNum = s_cull_segmentsNum = 0 ;
+}
+
+
+void
+work_stats_report
+( )
+{
+#ifdef COUNTERS
+  LOGD( "work:: %d f_XY, %d Q_div, %d Q_sqrt, %d occlusion tests, %d probes (%d per 10 tests), %d terminator steps, %d segments"
+      , s_work_fXYNum, s_work_divNum, s_work_sqrtNum
+      , s_work_testsNum, s_work_probesNum, (s_work_testsNum > 0) ? s_work_probesNum * 10 / s_work_testsNum : 0
+      , s_work_terminatorStepsNum, s_work_segmentsNum
+      ) ;
+
+  s_work_fXYNum = s_work_divNum = s_work_sqrtNum = s_work_testsNum = s_work_probesNum = 0 ;
+  s_work_terminatorStepsNum = s_work_segmentsNum = 0 ;
+#endif
+}
+
+
+// Projects a world point into its (possibly compact) screen storage.
+inline
+static
+GPoint
+screen_store
+( ScreenStore *store, const Q3 world )
+{
+  GPoint screen ;  screen_project( &screen, world ) ;
+
+#ifdef GRID_COMPACT
+  const int dx = screen.x - screen_center.x ;
+  const int dy = screen.y - screen_center.y ;
+
+  if (dx > SCREEN_OFFSET_NONE  &&  dx <= INT8_MAX  &&  dy > SCREEN_OFFSET_NONE  &&  dy <= INT8_MAX)
+    *store = (ScreenOffset){ .x = dx, .y = dy } ;
+  else
+    *store = (ScreenOffset){ .x = SCREEN_OFFSET_NONE, .y = SCREEN_OFFSET_NONE } ;
+#else
+  *store = screen ;
+#endif
+
+  return screen ;
+}
+
+
+// Screen point of a stored world point. Compact offsets out of the 8 bit range (rare, off screen) are projected again.
+inline
+static
+GPoint
+screen_load
+( const ScreenStore store, const Q3 world )
+{
+#ifdef GRID_COMPACT
+  if (store.x != SCREEN_OFFSET_NONE)
+    return GPoint( screen_center.x + store.x, screen_center.y + store.y ) ;
+
+  GPoint screen ;  screen_project( &screen, world ) ;
+  return screen ;
+#else
+  return store ;
+#endif
+}
+
+
+/***  ---------------  OSCILLATOR MODE  ---------------  ***/
+
+void
+oscillatorMode_set
+( Oscilator pOscilator )
+{
+  if (s_oscillator == pOscilator)
+    return ;
+
+  switch (s_oscillator = pOscilator)
+  {
+    case OSCILLATOR_FLOATING:
       Q3_set( &s_cam_viewPoint, Q_from_float( +0.1f ), Q_from_float( -1.0f ), Q_from_float( +0.7f ) ) ;
       cam_config( s_cam_viewPoint, s_cam_rotZangle = 0, s_cam_rotXangle = 0 ) ;
       position_setFromSensors( &oscillator_position ) ;
@@ -447,7 +1113,8 @@ oscillatorMode_set
     break ;
   } ;
 
-  grid_dist2osc_update( ) ;
+  frame_invalidate( FRAME_DIRTY_DIST2OSC ) ;
+  grid_projection_invalidate( ) ;
 }
 
 
@@ -482,7 +1149,7 @@ oscillatorMode_change_click_handler
 ( ClickRecognizerRef recognizer
 , void              *context
 )
-{ oscillatorMode_change( ) ; }
+{ TRACE_CLICK( TRACE_CLICK_OSCILLATOR ) ;  activity_wake( ) ;  oscillatorMode_change( ) ;  frame_click( ) ; }
 
 
 /***  ---------------  z := f( x, y )  ---------------  ***/
@@ -500,23 +1167,55 @@ oscillator_distance
 }
 
 
+// Oscillator phase at a simulation step, wraps around every 256 steps.
+inline
+static
+int32_t
+oscillator_phase
+( const int step )
+{ return TRIG_MAX_ANGLE - ((step << 8) & 0xFFFF) ; }   //  2*PI - (256 * step) % TRIG_MAX_RATIO
+
+
 inline
 static
 Q
-f_distance
-( const Q dist )
+f_distance_atPhase
+( const Q        dist
+, const int32_t  phase
+)
 {
-  const int32_t angle = ((dist >> 1) + oscillator_anglePhase) & 0xFFFF ;   //  (distance2oscillator / 2 + anglePhase) % TRIG_MAX_RATIO
-  return cos_lookup( angle ) ;                                             //  z = f( x, y )
+  const int32_t angle = ((dist >> 1) + phase) & 0xFFFF ;   //  (distance2oscillator / 2 + anglePhase) % TRIG_MAX_RATIO
+  return cos_lookup( angle ) ;                             //  z = f( x, y )
 }
 
 
+inline
+static
+Q
+f_distance
+( const Q dist )
+{ return f_distance_atPhase( dist, oscillator_anglePhase ) ; }
+
+
+// Height to its S0.7 int8 store: a crest of exactly +1.0 (cos_lookup( ) at angle 0) saturates to 127/128 instead of
+// wrapping to -1.0.
+inline
+static
+int8_t
+z_pack
+( const Q z )
+{ return (z >= Q_1) ? INT8_MAX : z >> Z_SHIFT ; }
+
+
 inline
 static
 Q
 f_XY
 ( const Q x, const Q y )
-{ return f_distance( oscillator_distance( x, y ) ) ; }
+{
+  WORK_COUNT( s_work_fXYNum ) ;
+  return f_distance( oscillator_distance( x, y ) ) ;
+}
 
 
 /***  ---------------  Hidden line removal  ---------------  ***/
@@ -531,6 +1230,8 @@ function_isVisible_fromPoint
   Q3 point2viewer ;  Q3_sub( &point2viewer, &viewPoint, &point ) ;
   Q  k ;
 
+  WORK_COUNT( s_work_testsNum ) ;
+
   //  1) Clip the view line to the nearest min/max box wall.
   if (viewPointBoxing.xMajor)
     k = Q_div( world_xMax - point.x, point2viewer.x ) ;
@@ -592,6 +1293,8 @@ function_isVisible_fromPoint
         ; k += bigStepK ,  Q3_add( &probe, &probe, &bigStep )
         )
     {
+      WORK_COUNT( s_work_probesNum ) ;
+
       Q probeAltitude = probe.z - f_XY( probe.x, probe.y ) ;
 
       if (probeAltitude > Q_0)
@@ -616,8 +1319,6 @@ function_isVisible_fromPoint
 
 
 #ifdef GIF
-  void world_update_timer_handler( void *data ) ;
-
   void
   gifStepper_advance_click_handler
   ( ClickRecognizerRef recognizer
@@ -628,93 +1329,77 @@ function_isVisible_fromPoint
       s_world_updateTimer_ptr = app_timer_register( 0, world_update_timer_handler, NULL ) ;   // Schedule a world update.
   }
 #else
-  Sampler   *accelSampler_x = NULL ;    // To be allocated at accelSamplers_initialize( ).
-  Sampler   *accelSampler_y = NULL ;    // To be allocated at accelSamplers_initialize( ).
-  Sampler   *accelSampler_z = NULL ;    // To be allocated at accelSamplers_initialize( ).
-
-
-  void
-  accelSamplers_initialize
-  ( )
-  {
-    accelSampler_x = Sampler_new( ACCEL_SAMPLER_CAPACITY ) ;
-    accelSampler_y = Sampler_new( ACCEL_SAMPLER_CAPACITY ) ;
-    accelSampler_z = Sampler_new( ACCEL_SAMPLER_CAPACITY ) ;
-
-    for (int i = 0  ;  i < ACCEL_SAMPLER_CAPACITY  ;  ++i)
-    {
-      Sampler_push( accelSampler_x,  -81 ) ;   // STEADY viewPoint attractor.
-      Sampler_push( accelSampler_y, -816 ) ;   // STEADY viewPoint attractor.
-      Sampler_push( accelSampler_z, -571 ) ;   // STEADY viewPoint attractor.
-    }
-  }
-
-
-  void
-  accelSamplers_finalize
-  ( )
-  {
-    free( Sampler_free( accelSampler_x ) ) ; accelSampler_x = NULL ;
-    free( Sampler_free( accelSampler_y ) ) ; accelSampler_y = NULL ;
-    free( Sampler_free( accelSampler_z ) ) ; accelSampler_z = NULL ;
-  }
-
-
-  // Acellerometer handlers.
-  void
-  accel_data_service_handler
-  ( AccelData *data
-  , uint32_t   num_samples
-  )
-  { }
+  // Wrist level, the cam's view point while the accelerometer has not reported yet (mG).
+  static const AccelSample  accel_steady = { .x = -81, .y = -816, .z = -571 } ;
 #endif
 
 
 /***  ---------------  oscillator---------  ***/
 
-static Q        dy2[GRID_LINES] ;   // Auxiliary array.
+static Q        dy2[2*GRID_LINES_MAX - 1] ;   // Auxiliary array, shared by the major and minor rows.
 
 
 void
-grid_major_dist2osc_update
-( )
+Lattice_dist2osc_update
+( Lattice           *l
+, const LatticeView  view
+)
 {
-  for (int j = 0  ;  j < GRID_LINES  ;  j++)
+  const int size = Lattice_size( l ) ;
+  const int step = Lattice_step( view ) ;
+
+  for (int c = 0  ;  c < size  ;  c += step)
   {
-    const Q dy = oscillator_position.y - (grid_major_y[j] << COORD_SHIFT) ;
-    dy2[j] = Q_mul( dy, dy ) ;
+    const Q dy = oscillator_position.y - (l->yCoord[c] << COORD_SHIFT) ;
+    dy2[c] = Q_mul( dy, dy ) ;
   }
 
-  for (int i = 0  ;  i < GRID_LINES  ;  i++)
+  for (int r = 0  ;  r < size  ;  r += step)
   {
-    const Q dx    = oscillator_position.x - (grid_major_x[i] << COORD_SHIFT) ;
-    const Q dx2_i = Q_mul( dx, dx ) ;
+    const Q dx    = oscillator_position.x - (l->xCoord[r] << COORD_SHIFT) ;
+    const Q dx2_r = Q_mul( dx, dx ) ;
 
-    for (int j = 0  ;  j < GRID_LINES  ;  j++)
-      grid_major_dist2osc[i][j] = Q_sqrt( dx2_i + dy2[j] ) >> DIST_SHIFT ;
+    for (int k = 0, c = r & 1  ;  k < Lattice_rowLength( l, r )  ;  ++k, c += 2)
+      l->dist2osc[Lattice_point( l, r, k )] = Q_sqrt( dx2_r + dy2[c] ) >> DIST_SHIFT ;
   }
 }
 
 
-void
-grid_minor_dist2osc_update
-( )
-{
-  for (int j = 0  ;  j < GRID_LINES-1  ;  j++)
-  {
-    const Q dy = oscillator_position.y - (grid_minor_y[j] << COORD_SHIFT) ;
-    dy2[j] = Q_mul( dy, dy ) ;
-  }
+#ifdef LOD
+  static bool  lod_movedX[2*GRID_LINES_MAX - 1] ;   // Lattice rows and columns the LOD moved since their distances were last updated.
+  static bool  lod_movedY[2*GRID_LINES_MAX - 1] ;
+
 
-  for (int i = 0  ;  i < GRID_LINES-1  ;  i++)
+  // Distances of the points on the rows and columns the LOD moved, the others kept: for an oscillator that stays put.
+  void
+  Lattice_dist2osc_lod_update
+  ( Lattice           *l
+  , const LatticeView  view
+  )
   {
-    const Q dx    = oscillator_position.x - (grid_minor_x[i] << COORD_SHIFT) ;
-    const Q dx2_i = Q_mul( dx, dx ) ;
+    const int size = Lattice_size( l ) ;
+    const int step = Lattice_step( view ) ;
 
-    for (int j = 0  ;  j < GRID_LINES-1  ;  j++)
-      grid_minor_dist2osc[i][j] = Q_sqrt( dx2_i + dy2[j] ) >> DIST_SHIFT ;
+    for (int c = 0  ;  c < size  ;  c += step)
+    {
+      const Q dy = oscillator_position.y - (l->yCoord[c] << COORD_SHIFT) ;
+      dy2[c] = Q_mul( dy, dy ) ;
+    }
+
+    for (int r = 0  ;  r < size  ;  r += step)
+    {
+      const Q dx    = oscillator_position.x - (l->xCoord[r] << COORD_SHIFT) ;
+      const Q dx2_r = Q_mul( dx, dx ) ;
+
+      for (int k = 0, c = r & 1  ;  k < Lattice_rowLength( l, r )  ;  ++k, c += 2)
+        if (lod_movedX[r]  ||  lod_movedY[c])
+          l->dist2osc[Lattice_point( l, r, k )] = Q_sqrt( dx2_r + dy2[c] ) >> DIST_SHIFT ;
+    }
+
+    memset( lod_movedX, 0, sizeof(lod_movedX) ) ;
+    memset( lod_movedY, 0, sizeof(lod_movedY) ) ;
   }
-}
+#endif
 
 
 void
@@ -725,11 +1410,15 @@ grid_dist2osc_update
   {
     case PATTERN_DOTS:
     case PATTERN_STRIPES:
-      grid_minor_dist2osc_update( ) ;
-
     case PATTERN_LINES:
     case PATTERN_GRID:
-      grid_major_dist2osc_update( ) ;
+      Lattice_dist2osc_update( s_lattice, pattern_latticeView( s_pattern ) ) ;
+    break ;
+
+    case PATTERN_RINGS:
+#ifdef PBL_COLOR
+      rings_dist2osc_update( ) ;
+#endif
     break ;
 
     case PATTERN_UNDEFINED:
@@ -738,31 +1427,78 @@ grid_dist2osc_update
 }
 
 
+// (Re)allocates the lattice for a new resolution, capped by what the heap can afford.
 void
-grid_initialize
+grid_resolution_set
+( int lines )
+{
+  const int affordable = grid_lines_affordable( ) ;
+
+  if (lines > affordable)
+    lines = affordable ;
+
+  if (s_lattice != NULL  &&  s_lattice->lines == lines)
+    return ;
+
+  s_pattern = pattern_lattice_set( lines, s_pattern ) ;
+
+  // Newly allocated rows, all recomputed by the frame restarted.
+  frame_invalidate( FRAME_DIRTY_DIST2OSC | FRAME_DIRTY_PALETTE ) ;
+  grid_projection_invalidate( ) ;
+}
+
+
+// Cycles the grid resolution up to the largest affordable, then wraps around to the coarsest.
+void
+grid_resolution_change
 ( )
 {
-  const Q distanceBetweenLines = Q_div( grid_scale, Q_from_int(GRID_LINES - 1) ) ;
+  // Next value of the cycle, even from a resolution off it (a lattice_set( ) fall back). The heap cap, the resolution
+  // the app may have started with, ends the cycle when the default or the step beyond it can not be afforded.
+  const int affordable = grid_lines_affordable( ) ;
+  int       lines      = GRID_LINES_FIRST + ((s_grid_lines - GRID_LINES_FIRST) / GRID_LINES_STEP + 1) * GRID_LINES_STEP ;
+
+  if (s_grid_lines < GRID_LINES_FIRST)
+    lines = GRID_LINES_FIRST ;
+  else if (lines > affordable)
+    lines = (s_grid_lines < affordable) ? affordable : GRID_LINES_FIRST ;
+
+  grid_resolution_set( lines ) ;
+}
+
+
+void
+grid_resolution_change_click_handler
+( ClickRecognizerRef recognizer
+, void              *context
+)
+{ TRACE_CLICK( TRACE_CLICK_GRID_RESOLUTION ) ;  activity_wake( ) ;  grid_resolution_change( ) ;  frame_click( ) ; }
 
+
+void
+grid_initialize
+( )
+{
   world_xMin = world_yMin = -grid_halfScale ;
   world_xMax = world_yMax = +grid_halfScale ;
   world_zMin = -Q_1 ;
   world_zMax = +Q_1 ;
 
-  int l ;
-  Q   lCoord ;
+  grid_resolution_set( GRID_LINES_DEFAULT ) ;
 
-  for ( l = 0          , lCoord = -grid_halfScale
-      ; l < GRID_LINES
-      ; l++            , lCoord += distanceBetweenLines
-      )
-    grid_major_x[l] = grid_major_y[l] = lCoord >> COORD_SHIFT ;
+#ifdef PBL_COLOR
+  // Rings spaced to reach the grid's diagonal, the farthest the oscillator can be from any grid point.
+  rings_step = Q_div( Q_mul( grid_scale, Q_from_float(1.41421356f) ), Q_from_int(RINGS_NUM) ) ;
+  rings_num  = RINGS_NUM ;
 
-  for ( l = 0          , lCoord = -grid_halfScale + (distanceBetweenLines >> 1)
-      ; l < GRID_LINES-1
-      ; l++            , lCoord += distanceBetweenLines
-      )
-    grid_minor_x[l] = grid_minor_y[l] = lCoord >> COORD_SHIFT ;
+  for (int s = 0  ;  s < SPOKES_NUM  ;  ++s)
+  {
+    const int32_t angle = (TRIG_MAX_ANGLE * s) / SPOKES_NUM ;
+
+    spokes_cos[s] = cos_lookup( angle ) ;
+    spokes_sin[s] = sin_lookup( angle ) ;
+  }
+#endif
 }
 
 
@@ -795,34 +1531,52 @@ static bool       s_color_isInverted ;
   }
 
 
+  static GColor  s_palette[1 << PALETTE_BITS] ;
+
   void
-  set_stroke_color
-  ( GContext    *gCtx
-  , const Fuxel  f
-  )
+  palette_set
+  ( )
   {
     switch (s_colorization)
     {
       case COLORIZATION_SIGNAL:
-        graphics_context_set_stroke_color( gCtx, f.world.z > Q_0  ?  GColorMelon  :  GColorVividCerulean ) ;
+        s_palette[1] = GColorMelon ;
+        s_palette[0] = GColorVividCerulean ;
       break ;
 
       case COLORIZATION_DIST:
-        graphics_context_set_stroke_color( gCtx, s_colorMap[(f.dist2osc >> 15) & 0b111] ) ;      //  (2 * distance) % 8
+        memcpy( s_palette, s_colorMap, sizeof(s_palette) ) ;
       break ;
 
       case COLORIZATION_LIGHT:
-        graphics_context_set_stroke_color( gCtx, f.visibility.fromLight1 ? s_color_stroke : GColorDarkGray ) ;
+        s_palette[1] = s_color_stroke ;
+        s_palette[0] = GColorDarkGray ;
       break ;
 
       case COLORIZATION_MONO:
       case COLORIZATION_UNDEFINED:
-        graphics_context_set_stroke_color( gCtx, s_color_stroke ) ;
+        s_palette[0] = s_color_stroke ;
       break ;
     } ;
   }
 
 
+  inline
+  static
+  GColor
+  get_stroke_color
+  ( const Fuxel  f )
+  { return s_palette[f.paletteIndex] ; }
+
+
+  void
+  set_stroke_color
+  ( GContext    *gCtx
+  , const Fuxel  f
+  )
+  { graphics_context_set_stroke_color( gCtx, get_stroke_color( f ) ) ; }
+
+
   static bool   s_antialiasing = ANTIALIASING_DEFAULT ;
 
   void
@@ -830,7 +1584,7 @@ static bool       s_color_isInverted ;
   ( ClickRecognizerRef recognizer
   , void              *context
   )
-  { s_antialiasing = !s_antialiasing ; }
+  { TRACE_CLICK( TRACE_CLICK_ANTIALIASING ) ;  activity_wake( ) ;  s_antialiasing = !s_antialiasing ;  frame_click( ) ; }
 #else
   void
   color_initialize
@@ -842,41 +1596,41 @@ static bool       s_color_isInverted ;
   }
 
 
-  ink_t
-  get_stroke_ink
-  ( const Fuxel  f )
+  static ink_t  s_palette[1 << PALETTE_BITS] ;
+
+  void
+  palette_set
+  ( )
   {
     switch (s_colorization)
     {
-      case COLORIZATION_MONO:
-        return INK100 ;
-
       case COLORIZATION_SIGNAL:
-        return  f.world.z > Q_0  ?  INK100  :  INK33 ;
-
-      case COLORIZATION_DIST:
-        switch ((f.dist2osc >> 15) & 0b1 )   //  (2 * distance) % 2
-        {
-          case 1:
-            return INK33 ;
-
-          case 0:
-          default:
-            return INK100 ;
-        }
+      case COLORIZATION_LIGHT:
+        s_palette[1] = INK100 ;
+        s_palette[0] = INK33 ;
       break ;
 
-      case COLORIZATION_LIGHT:
-        return f.visibility.fromLight1 ? INK100 : INK33 ;
+      case COLORIZATION_DIST:
+        s_palette[1] = INK33 ;
+        s_palette[0] = INK100 ;
       break ;
 
+      case COLORIZATION_MONO:
       case COLORIZATION_UNDEFINED:
-      default:
-        return INK100 ;
+        s_palette[0] = INK100 ;
+      break ;
     } ;
   }
 
 
+  inline
+  static
+  ink_t
+  get_stroke_ink
+  ( const Fuxel  f )
+  { return s_palette[f.paletteIndex] ; }
+
+
   void
   invert_change
   ( )
@@ -904,136 +1658,358 @@ static bool       s_color_isInverted ;
   ( ClickRecognizerRef recognizer
   , void              *context
   )
-  { invert_change( ) ; }
+  { TRACE_CLICK( TRACE_CLICK_INVERT ) ;  activity_wake( ) ;  invert_change( ) ;  frame_click( ) ; }
 #endif
 
 
-void
-world_initialize
-( )
+// Palette index of a point for the current colorization.
+inline
+static
+uint8_t
+palette_index
+( const Q     z
+, const Q     dist2osc
+, const bool  fromLight1
+)
 {
-  pattern_set( PATTERN_DEFAULT ) ;
-  grid_initialize( ) ;
-  color_initialize( ) ;
+  switch (s_colorization)
+  {
+    case COLORIZATION_SIGNAL:
+      return z > Q_0 ;
 
-  colorization_set( COLORIZATION_DEFAULT ) ;
-  oscillatorMode_set( OSCILLATOR_DEFAULT ) ;
-  transparency_set( TRANSPARENCY_DEFAULT ) ;
+    case COLORIZATION_DIST:
+      return (dist2osc >> 15) & ((1 << PALETTE_BITS) - 1) ;   //  (2 * distance) % palette size
 
-#ifndef GIF
-  accelSamplers_initialize( ) ;
-#endif
+    case COLORIZATION_LIGHT:
+      return fromLight1 ;
 
-  cam_initialize( ) ;
-  light_initialize( ) ;
+    case COLORIZATION_MONO:
+    case COLORIZATION_UNDEFINED:
+    default:
+      return 0 ;
+  }
 }
 
 
-// UPDATE WORLD OBJECTS PROPERTIES
-
+// Sets the palette index of vertex j in a row of palette bit planes.
+inline
+static
 void
-grid_major_z_update
-( )
+palette_row_set
+( uint32_t      *row
+, const int      words
+, const int      j
+, const uint8_t  index
+)
 {
-  for (int i = 0  ;  i < GRID_LINES  ;  ++i)
-    for (int j = 0  ;  j < GRID_LINES  ;  ++j)
-      grid_major_z[i][j] = f_distance( grid_major_dist2osc[i][j] << DIST_SHIFT ) >> Z_SHIFT ;
+  for (int b = 0  ;  b < PALETTE_BITS  ;  ++b)
+    bits_set( row + b * words, j, (index >> b) & 1 ) ;
 }
 
 
+// Sets the same palette index for all vertices of a row of palette bit planes.
+inline
+static
 void
-grid_minor_z_update
-( )
+palette_row_fill
+( uint32_t      *row
+, const int      words
+, const uint8_t  index
+)
 {
-  for (int i = 0  ;  i < GRID_LINES-1  ;  i++)
-    for (int j = 0  ;  j < GRID_LINES-1  ;  j++)
-      grid_minor_z[i][j] = f_distance( grid_minor_dist2osc[i][j] << DIST_SHIFT ) >> Z_SHIFT ;
+  for (int b = 0  ;  b < PALETTE_BITS  ;  ++b)
+    for (int w = 0  ;  w < words  ;  ++w)
+      row[b * words + w] = ((index >> b) & 1) ? ~0u : 0u ;
 }
 
 
-void
-grid_z_update
-( )
+inline
+static
+uint8_t
+palette_row_get
+( const uint32_t *row
+, const int       words
+, const int       j
+)
 {
-  switch (s_pattern)
-  {
-    case PATTERN_DOTS:
-    case PATTERN_STRIPES:
-      grid_minor_z_update( ) ;
+  uint8_t index = 0 ;
 
-    case PATTERN_GRID:
-    case PATTERN_LINES:
-      grid_major_z_update( ) ;
-    break ;
+  for (int b = 0  ;  b < PALETTE_BITS  ;  ++b)
+    index |= bits_get( row + b * words, j ) << b ;
 
-    case PATTERN_UNDEFINED:
-    break ;
-  } ;
+  return index ;
 }
 
 
+// Sets the palette index of all vertices of a row to the bits of a one bit plane row (0 or 1 per vertex).
+inline
+static
 void
-grid_major_visibility_update
-( )
+palette_row_setPlane
+( uint32_t       *row
+, const int       words
+, const uint32_t *plane
+)
 {
-  switch (s_transparency)
-  {
-    case TRANSPARENCY_OPAQUE:
-    case TRANSPARENCY_XRAY:
-      for (int i = 0  ;  i < GRID_LINES  ;  ++i)
-      {
-        const Q  grid_major_x_i = grid_major_x[i] << COORD_SHIFT ;
-
-        for (int j = 0  ;  j < GRID_LINES  ;  ++j)
-        {
-          Q3 world = (Q3){ .x = grid_major_x_i
-                         , .y = grid_major_y[j] << COORD_SHIFT
-                         , .z = grid_major_z[i][j] << Z_SHIFT
-                         } ;
-
-          const bool visFromCam = grid_major_visibility[i][j].fromCam = function_isVisible_fromPoint( world, s_cam.viewPoint, s_cam_viewPoint_boxing ) ;
-          
-          if (visFromCam  &&  s_colorization == COLORIZATION_LIGHT)
-            grid_major_visibility[i][j].fromLight1 = function_isVisible_fromPoint( world, s_light, s_light_boxing ) ;
-        }
-      }
-    break ;
-
-    case TRANSPARENCY_TRANSLUCENT:
-      // Already set to true in transparency_set( )
-    break ;
+  for (int w = 0  ;  w < words  ;  ++w)
+    row[w] = plane[w] ;
 
-    case TRANSPARENCY_UNDEFINED:
-      // Already set to false in transparency_set( )
-    break ;
-  }
+  for (int w = words  ;  w < PALETTE_BITS * words  ;  ++w)
+    row[w] = 0u ;
 }
 
 
-void
-grid_minor_visibility_update
-( )
+inline
+static
+Visibility
+visibility_get
+( const uint32_t *row
+, const int       words
+, const int       j
+)
+{
+  return (Visibility){ .fromCam    = bits_get( row + VISIBILITY_FROM_CAM    * words, j )
+                     , .fromLight1 = bits_get( row + VISIBILITY_FROM_LIGHT1 * words, j )
+                     , .fromLight2 = bits_get( row + VISIBILITY_FROM_LIGHT2 * words, j )
+                     , .fromLight3 = bits_get( row + VISIBILITY_FROM_LIGHT3 * words, j )
+                     } ;
+}
+
+
+void
+world_initialize
+( )
+{
+  grid_initialize( ) ;
+  pattern_set( PATTERN_DEFAULT ) ;
+  color_initialize( ) ;
+
+  colorization_set( COLORIZATION_DEFAULT ) ;
+  oscillatorMode_set( OSCILLATOR_DEFAULT ) ;
+  transparency_set( TRANSPARENCY_DEFAULT ) ;
+
+  cam_initialize( ) ;
+  light_initialize( ) ;
+
+  grid_memory_report( ) ;
+}
+
+
+// UPDATE WORLD OBJECTS PROPERTIES
+
+// Rows [rFirst, rEnd) of the view.
+void
+Lattice_z_update
+( Lattice           *l
+, const LatticeView  view
+, const int          rFirst
+, const int          rEnd
+)
+{
+  // The light palette depends on visibility and is set by Lattice_visibility_update( ) instead.
+  const bool isPaletteFromZ = (s_colorization != COLORIZATION_LIGHT) ;
+
+  for (int r = rFirst  ;  r < rEnd  &&  r < Lattice_size( l )  ;  r += Lattice_step( view ))
+  {
+    uint32_t *palette = Lattice_paletteRow( l, r ) ;
+
+    for (int k = 0  ;  k < Lattice_rowLength( l, r )  ;  ++k)
+    {
+      const int rk       = Lattice_point( l, r, k ) ;
+      const Q   dist2osc = l->dist2osc[rk] << DIST_SHIFT ;
+
+      l->z[rk] = z_pack( f_distance( dist2osc ) ) ;
+
+#ifdef KEYFRAMES
+      l->zKey [rk] = l->z[rk] ;
+      l->zNext[rk] = z_pack( f_distance_atPhase( dist2osc, s_keyframe_nextPhase ) ) ;
+#endif
+
+      if (isPaletteFromZ)
+        palette_row_set( palette, l->words, k, palette_index( l->z[rk] << Z_SHIFT, dist2osc, false ) ) ;
+    }
+  }
+}
+
+
+#ifdef KEYFRAMES
+  // Heights of the step-th in-between frame, linearly interpolated from the last keyframe to the next one. The phase
+  // wrap needs no care here: both ends were computed with their own wrapped phase.
+  void
+  Lattice_z_interpolate
+  ( Lattice           *l
+  , const LatticeView  view
+  , const int          step
+  )
+  {
+    const bool isPaletteFromZ = (s_colorization != COLORIZATION_LIGHT) ;
+
+    for (int r = 0  ;  r < Lattice_size( l )  ;  r += Lattice_step( view ))
+    {
+      uint32_t *palette = Lattice_paletteRow( l, r ) ;
+
+      for (int k = 0  ;  k < Lattice_rowLength( l, r )  ;  ++k)
+      {
+        const int rk = Lattice_point( l, r, k ) ;
+
+        l->z[rk] = l->zKey[rk] + (l->zNext[rk] - l->zKey[rk]) * step / KEYFRAME_TICKS ;
+
+        if (isPaletteFromZ)
+          palette_row_set( palette, l->words, k, palette_index( l->z[rk] << Z_SHIFT, l->dist2osc[rk] << DIST_SHIFT, false ) ) ;
+      }
+    }
+  }
+
+
+  // Frames between keyframes only interpolate the lattice heights, then get re-projected by the caller with the
+  // keyframe visibility: no distances to the oscillator, no z, and occlusion tests only for the vertices back on screen
+  // since. Returns false for a keyframe, to be computed in full.
+  bool
+  keyframe_interpolate
+  ( )
+  {
+    const int step = s_world_updateCount - s_keyframe_tick ;
+
+    if (s_keyframe_isValid  &&  step < KEYFRAME_TICKS  &&  s_pattern != PATTERN_RINGS  &&  s_pattern != PATTERN_UNDEFINED)
+    {
+      oscillator_anglePhase = oscillator_phase( s_world_updateCount ) ;
+      Lattice_z_interpolate( s_lattice, pattern_latticeView( s_pattern ), step ) ;
+
+      return true ;
+    }
+
+    s_keyframe_tick      = s_world_updateCount ;
+    s_keyframe_nextPhase = oscillator_phase( s_keyframe_tick + KEYFRAME_TICKS ) ;
+    s_keyframe_isValid   = true ;
+
+    return false ;
+  }
+#endif
+
+
+// Chunked z update: up to count rows of the displayed pattern from row first on. Returns the row to carry on from, 0
+// once past the last row.
+int
+grid_z_updateRows
+( const int first
+, const int count
+)
+{
+  PROFILE_SCOPE( PROFILE_GRID_Z ) ;
+
+  switch (s_pattern)
+  {
+    case PATTERN_DOTS:
+    case PATTERN_STRIPES:
+    case PATTERN_GRID:
+    case PATTERN_LINES:
+      {
+        const LatticeView view = pattern_latticeView( s_pattern ) ;
+        const int         end  = first + count * Lattice_step( view ) ;
+
+        Lattice_z_update( s_lattice, view, first, end ) ;
+
+        return (end < Lattice_size( s_lattice )) ? end : 0 ;
+      }
+
+    case PATTERN_RINGS:
+#ifdef PBL_COLOR
+      // Only RINGS_NUM heights, always in one go.
+      rings_z_update( ) ;
+#endif
+    break ;
+
+    case PATTERN_UNDEFINED:
+    break ;
+  } ;
+
+  return 0 ;
+}
+
+
+// Occlusion tests of the todo vertices of word w of row r, from the cam and, under the light colorization, from the
+// light. Culled ones are left hidden from the cam, the vertices outside todo keep their visibility.
+void
+Lattice_visibility_updateWord
+( Lattice        *l
+, const int       r
+, const int       w
+, const uint32_t  todo
+)
+{
+  const Q   lattice_x_r = l->xCoord[r] << COORD_SHIFT ;
+  const int length      = Lattice_rowLength( l, r ) ;
+  uint32_t *row         = Lattice_visibilityRow( l, r ) ;
+  uint32_t *light1      = row + VISIBILITY_FROM_LIGHT1 * l->words ;
+  uint32_t *culled      = row + VISIBILITY_CULLED * l->words ;
+  uint32_t  fromCam     = 0u ;
+  uint32_t  fromLight1  = 0u ;
+
+  for (int b = 0, k = w << 5  ;  b < 32  &&  k < length  ;  ++b, ++k)
+  {
+    if (((todo >> b) & 1) == 0)
+      continue ;
+
+    // Culled points are left hidden from the cam.
+    if ((culled[w] >> b) & 1)
+    {
+      ++s_cull_testsNum ;
+      continue ;
+    }
+
+    Q3 world = (Q3){ .x = lattice_x_r
+                   , .y = l->yCoord[2*k + (r & 1)] << COORD_SHIFT
+                   , .z = l->z[Lattice_point( l, r, k )] << Z_SHIFT
+                   } ;
+
+#ifdef HEATMAP
+    const int probesNum = s_work_probesNum ;
+#endif
+
+    if (function_isVisible_fromPoint( world, s_cam.viewPoint, s_cam_viewPoint_boxing ))
+    {
+      fromCam |= 1u << b ;
+
+      if (s_colorization == COLORIZATION_LIGHT  &&  function_isVisible_fromPoint( world, s_light, s_light_boxing ))
+        fromLight1 |= 1u << b ;
+    }
+
+#ifdef HEATMAP
+    const int vertexProbes = s_work_probesNum - probesNum ;
+
+    l->probes[Lattice_point( l, r, k )] = (vertexProbes < UINT8_MAX) ? vertexProbes : UINT8_MAX ;
+#endif
+  }
+
+  row[VISIBILITY_FROM_CAM * l->words + w] = (row[VISIBILITY_FROM_CAM * l->words + w] & ~todo) | fromCam ;
+
+  // Vertices hidden from the cam keep their previous light visibility.
+  if (s_colorization == COLORIZATION_LIGHT)
+    light1[w] = (light1[w] & ~fromCam) | fromLight1 ;
+}
+
+
+// Rows [rFirst, rEnd) of the view.
+void
+Lattice_visibility_update
+( Lattice           *l
+, const LatticeView  view
+, const int          rFirst
+, const int          rEnd
+)
 {
   switch (s_transparency)
   {
     case TRANSPARENCY_OPAQUE:
     case TRANSPARENCY_XRAY:
-      for (int i = 0  ;  i < GRID_LINES-1  ;  ++i)
+      for (int r = rFirst  ;  r < rEnd  &&  r < Lattice_size( l )  ;  r += Lattice_step( view ))
       {
-        const Q  grid_minor_x_i = grid_minor_x[i] << COORD_SHIFT ;
+        // One word of the row at a time.
+        for (int w = 0  ;  w < l->words  ;  ++w)
+          Lattice_visibility_updateWord( l, r, w, ~0u ) ;
 
-        for (int j = 0  ;  j < GRID_LINES-1  ;  ++j)
-        {
-          Q3 world = (Q3){ .x = grid_minor_x_i
-                         , .y = grid_minor_y[j] << COORD_SHIFT
-                         , .z = grid_minor_z[i][j] << Z_SHIFT
-                         } ;
-
-          const bool visFromCam = grid_minor_visibility[i][j].fromCam = function_isVisible_fromPoint( world, s_cam.viewPoint, s_cam_viewPoint_boxing ) ;
-          
-          if (visFromCam  &&  s_colorization == COLORIZATION_LIGHT)
-            grid_minor_visibility[i][j].fromLight1 = function_isVisible_fromPoint( world, s_light, s_light_boxing ) ;
-        }
+        if (s_colorization == COLORIZATION_LIGHT)
+          palette_row_setPlane( Lattice_paletteRow( l, r ), l->words, Lattice_visibilityRow( l, r ) + VISIBILITY_FROM_LIGHT1 * l->words ) ;
       }
     break ;
 
@@ -1048,19 +2024,96 @@ grid_minor_visibility_update
 }
 
 
+// Chunked visibility update: up to count rows (rings) of the displayed pattern from row first on. Returns the row to
+// carry on from, 0 once past the last row.
+int
+grid_visibility_updateRows
+( const int first
+, const int count
+)
+{
+  PROFILE_SCOPE( PROFILE_VISIBILITY ) ;
+
+  switch (s_pattern)
+  {
+    case PATTERN_DOTS:
+    case PATTERN_STRIPES:
+    case PATTERN_GRID:
+    case PATTERN_LINES:
+      {
+        const LatticeView view = pattern_latticeView( s_pattern ) ;
+        const int         end  = first + count * Lattice_step( view ) ;
+
+        Lattice_visibility_update( s_lattice, view, first, end ) ;
+
+        return (end < Lattice_size( s_lattice )) ? end : 0 ;
+      }
+
+    case PATTERN_RINGS:
+#ifdef PBL_COLOR
+      rings_visibility_update( first, first + count ) ;
+
+      return (first + count < rings_num) ? first + count : 0 ;
+#endif
+    break ;
+
+    case PATTERN_UNDEFINED:
+    break ;
+  } ;
+
+  return 0 ;
+}
+
+
+// Full recompute of the palette indices from the current z, dist2osc and visibility. Used by the first frame complete
+// after a mode change, otherwise the indices are kept up to date by the z and visibility updates.
+void
+Lattice_palette_update
+( Lattice           *l
+, const LatticeView  view
+)
+{
+  for (int r = 0  ;  r < Lattice_size( l )  ;  r += Lattice_step( view ))
+  {
+    uint32_t       *palette = Lattice_paletteRow( l, r ) ;
+    const uint32_t *light1  = Lattice_visibilityRow( l, r ) + VISIBILITY_FROM_LIGHT1 * l->words ;
+
+    for (int k = 0  ;  k < Lattice_rowLength( l, r )  ;  ++k)
+      palette_row_set( palette
+                     , l->words
+                     , k
+                     , palette_index( l->z[Lattice_point( l, r, k )] << Z_SHIFT
+                                    , l->dist2osc[Lattice_point( l, r, k )] << DIST_SHIFT
+                                    , bits_get( light1, k )
+                                    )
+                     ) ;
+  }
+}
+
+
 void
-grid_visibility_update
+grid_palette_update
 ( )
 {
   switch (s_pattern)
   {
     case PATTERN_DOTS:
     case PATTERN_STRIPES:
-      grid_minor_visibility_update( ) ;
-
     case PATTERN_GRID:
     case PATTERN_LINES:
-      grid_major_visibility_update( ) ;
+      Lattice_palette_update( s_lattice, pattern_latticeView( s_pattern ) ) ;
+    break ;
+
+    case PATTERN_RINGS:
+#ifdef PBL_COLOR
+      for (int k = 0  ;  k < rings_num  ;  ++k)
+        for (int s = 0  ;  s < SPOKES_NUM  ;  ++s)
+          palette_row_set( rings_palette[k]
+                         , 1
+                         , s
+                         , palette_index( rings_z[k] << Z_SHIFT, rings_step * (k+1), (rings_visibility[k][VISIBILITY_FROM_LIGHT1] >> s) & 1 )
+                         ) ;
+#endif
     break ;
 
     case PATTERN_UNDEFINED:
@@ -1069,13 +2122,123 @@ grid_visibility_update
 }
 
 
+#ifdef PBL_COLOR
+  // World coordinates of ring k, spoke s. Returns false if the vertex falls outside the world box.
+  inline
+  static
+  bool
+  rings_world
+  ( Q3       *world
+  , const int k
+  , const int s
+  )
+  {
+    const Q radius = rings_step * (k+1) ;
+
+    world->x = oscillator_position.x + Q_mul( radius, spokes_cos[s] ) ;
+    world->y = oscillator_position.y + Q_mul( radius, spokes_sin[s] ) ;
+    world->z = rings_z[k] << Z_SHIFT ;
+
+    return world_xMin <= world->x  &&  world->x <= world_xMax
+        && world_yMin <= world->y  &&  world->y <= world_yMax ;
+  }
+
+
+  void
+  rings_dist2osc_update
+  ( )
+  {
+    // Rings beyond the farthest world box corner are entirely outside the grid.
+    const Q dx = (oscillator_position.x > Q_0) ? oscillator_position.x - world_xMin : world_xMax - oscillator_position.x ;
+    const Q dy = (oscillator_position.y > Q_0) ? oscillator_position.y - world_yMin : world_yMax - oscillator_position.y ;
+
+    rings_num = Q_sqrt( Q_mul( dx, dx ) + Q_mul( dy, dy ) ) / rings_step ;
+
+    if (rings_num > RINGS_NUM)
+      rings_num = RINGS_NUM ;
+  }
+
+
+  void
+  rings_z_update
+  ( )
+  {
+    // The light palette depends on visibility and is set by rings_visibility_update( ) instead.
+    const bool isPaletteFromZ = (s_colorization != COLORIZATION_LIGHT) ;
+
+    // Radially symmetric: one function evaluation (and palette index) per ring, shared by all its spokes.
+    for (int k = 0  ;  k < rings_num  ;  ++k)
+    {
+      rings_z[k] = z_pack( f_distance( rings_step * (k+1) ) ) ;
+
+      if (isPaletteFromZ)
+        palette_row_fill( rings_palette[k], 1, palette_index( rings_z[k] << Z_SHIFT, rings_step * (k+1), false ) ) ;
+    }
+  }
+
+
+  void
+  // Rings [kFirst, kEnd).
+  rings_visibility_update
+  ( const int kFirst
+  , const int kEnd
+  )
+  {
+    switch (s_transparency)
+    {
+      case TRANSPARENCY_OPAQUE:
+      case TRANSPARENCY_XRAY:
+        for (int k = kFirst  ;  k < kEnd  &&  k < rings_num  ;  ++k)
+        {
+          uint32_t fromCam    = 0u ;
+          uint32_t fromLight1 = 0u ;
+
+          for (int s = 0  ;  s < SPOKES_NUM  ;  ++s)
+          {
+            Q3 world ;
+
+            // Vertices outside the world box are never visible.
+            if (rings_world( &world, k, s )  &&  function_isVisible_fromPoint( world, s_cam.viewPoint, s_cam_viewPoint_boxing ))
+            {
+              fromCam |= 1u << s ;
+
+              if (s_colorization == COLORIZATION_LIGHT  &&  function_isVisible_fromPoint( world, s_light, s_light_boxing ))
+                fromLight1 |= 1u << s ;
+            }
+          }
+
+          rings_visibility[k][VISIBILITY_FROM_CAM] = fromCam ;
+
+          if (s_colorization == COLORIZATION_LIGHT)
+          {
+            // Vertices hidden from the cam keep their previous light visibility.
+            uint32_t *light1 = &rings_visibility[k][VISIBILITY_FROM_LIGHT1] ;
+
+            *light1 = (*light1 & ~fromCam) | fromLight1 ;
+            palette_row_setPlane( rings_palette[k], 1, light1 ) ;
+          }
+        }
+      break ;
+
+      case TRANSPARENCY_TRANSLUCENT:
+        // Already set to true in transparency_set( )
+      break ;
+
+      case TRANSPARENCY_UNDEFINED:
+        // Already set to false in transparency_set( )
+      break ;
+    }
+  }
+#endif
+
+
 Q2*
 position_setFromSensors
 ( Q2 *positionPtr )
 {
-  AccelData ad ;
+  AccelSample ad ;
 
-  if (accel_service_peek( &ad ) < 0)         // Accel service not available.
+  if (!Accel_latest( &ad ))                  // Accel service not available (yet).
     *positionPtr = Q2_origin ;
   else
   {
@@ -1091,9 +2254,9 @@ Q2*
 acceleration_setFromSensors
 ( Q2 *accelerationPtr )
 {
-  AccelData ad ;
+  AccelSample ad ;
 
-  if (accel_service_peek( &ad ) < 0)         // Accel service not available.
+  if (!Accel_latest( &ad ))                  // Accel service not available (yet).
     *accelerationPtr = Q2_origin ;
   else
   {
@@ -1107,10 +2270,15 @@ acceleration_setFromSensors
 
 // UPDATE CAMERA
 
+// Accelerometer mG to Q16.16 units of g, |mG| up to 4000 keeps the shifted value within 31 bits.
+#define Q_from_mG(mG)   (((Q)(mG) << 16) / 1000)
+
 void
 camera_update
 ( )
 {
+  PROFILE_SCOPE( PROFILE_CAMERA ) ;
+
   switch (s_oscillator)
   {
     case OSCILLATOR_ANCHORED:
@@ -1119,57 +2287,29 @@ camera_update
         Q3_set( &s_cam_viewPoint, Q_from_float( -0.1f ), Q_from_float( +1.0f ), Q_from_float( +0.7f ) ) ;
       #else
       {
-        // Non GIF => Interactive: use acelerometer to affect camera's view point position.
-        AccelData ad ;
+        // Non GIF => Interactive: use acelerometer to affect camera's view point position, the ring buffer mean adding
+        // inertia to dampen its jerkiness.
+        AccelSample mean ;
 
-        if (accel_service_peek( &ad ) < 0)         // Accel service not available.
-        {
-          Sampler_push( accelSampler_x,  -81 ) ;   // STEADY viewPoint attractor.
-          Sampler_push( accelSampler_y, -816 ) ;   // STEADY viewPoint attractor.
-          Sampler_push( accelSampler_z, -571 ) ;   // STEADY viewPoint attractor.
-        }
-        else
-        {
-          #ifdef EMU
-            if (ad.x == 0  &&  ad.y == 0  &&  ad.z == -1000)   // Under EMU with SENSORS off this is the default output.
-            {
-              Sampler_push( accelSampler_x,  -81 ) ;
-              Sampler_push( accelSampler_y, -816 ) ;
-              Sampler_push( accelSampler_z, -571 ) ;
-            }
-            else                                               // If running under EMU the SENSOR feed must be ON.
-            {
-              Sampler_push( accelSampler_x, ad.x ) ;
-              Sampler_push( accelSampler_y, ad.y ) ;
-              Sampler_push( accelSampler_z, ad.z ) ;
-            }
-          #else
-            Sampler_push( accelSampler_x, ad.x ) ;
-            Sampler_push( accelSampler_y, ad.y ) ;
-            Sampler_push( accelSampler_z, ad.z ) ;
-          #endif
-        }
+        if (!Accel_mean( &mean ))                  // Accel service not available (yet).
+          mean = accel_steady ;
 
-        const float kAvg = 0.001f / accelSampler_x->samplesNum ;
-        const float avgX = (float)(kAvg * accelSampler_x->samplesAcum ) ;
-        const float avgY =-(float)(kAvg * accelSampler_y->samplesAcum ) ;
-        const float avgZ =-(float)(kAvg * accelSampler_z->samplesAcum ) ;
+        #ifdef EMU
+          if (mean.x == 0  &&  mean.y == 0  &&  mean.z == -1000)   // Under EMU with SENSORS off this is the default output.
+            mean = accel_steady ;                                  // If running under EMU the SENSOR feed must be ON.
+        #endif
 
-        Q3_set( &s_cam_viewPoint, Q_from_float( avgX ), Q_from_float( avgY ), Q_from_float( avgZ ) ) ;
+        // No FPU: straight from mG to Q16.16, integer only.
+        Q3_set( &s_cam_viewPoint, Q_from_mG( mean.x ), -Q_from_mG( mean.y ), -Q_from_mG( mean.z ) ) ;
       }
       #endif
 
-      s_cam_rotZangle += s_cam_rotZangleSpeed ;  s_cam_rotZangle &= 0xFFFF ;        // Keep angle normalized.
-      s_cam_rotXangle += s_cam_rotXangleSpeed ;  s_cam_rotXangle &= 0xFFFF ;        // Keep angle normalized.
-
       cam_config( s_cam_viewPoint, s_cam_rotZangle, s_cam_rotXangle ) ;
     break ;
 
     case OSCILLATOR_FLOATING:
     case OSCILLATOR_BOUNCING:
       #ifdef GIF
-        s_cam_rotZangle += s_cam_rotZangleSpeed ;  s_cam_rotZangle &= 0xFFFF ;        // Keep angle normalized.
-        s_cam_rotXangle += s_cam_rotXangleSpeed ;  s_cam_rotXangle &= 0xFFFF ;        // Keep angle normalized.
         cam_config( s_cam_viewPoint, s_cam_rotZangle, s_cam_rotXangle ) ;
       #endif
     break ;
@@ -1180,23 +2320,39 @@ camera_update
 }
 
 
+// One SIM_STEP_MS tick of the cam rotation, applied by camera_update( ).
 void
-oscillator_update
+camera_step
 ( )
 {
-  oscillator_anglePhase = TRIG_MAX_ANGLE - ((s_world_updateCount << 8) & 0xFFFF) ;   //  2*PI - (256 * s_world_updateCount) % TRIG_MAX_RATIO
-
   switch (s_oscillator)
   {
     case OSCILLATOR_ANCHORED:
-      //  No need to call grid_dist2osc_update( ) because oscillator is not moving.
+      s_cam_rotZangle += s_cam_rotZangleSpeed ;  s_cam_rotZangle &= 0xFFFF ;        // Keep angle normalized.
+      s_cam_rotXangle += s_cam_rotXangleSpeed ;  s_cam_rotXangle &= 0xFFFF ;        // Keep angle normalized.
     break ;
 
     case OSCILLATOR_FLOATING:
-      position_setFromSensors( &oscillator_position ) ;
-      grid_dist2osc_update( ) ;
+    case OSCILLATOR_BOUNCING:
+      #ifdef GIF
+        s_cam_rotZangle += s_cam_rotZangleSpeed ;  s_cam_rotZangle &= 0xFFFF ;        // Keep angle normalized.
+        s_cam_rotXangle += s_cam_rotXangleSpeed ;  s_cam_rotXangle &= 0xFFFF ;        // Keep angle normalized.
+      #endif
+    break ;
+
+    case OSCILLATOR_UNDEFINED:
     break ;
+  }
+}
 
+
+// One SIM_STEP_MS tick of the oscillator dynamics, whatever the render rate.
+void
+oscillator_step
+( )
+{
+  switch (s_oscillator)
+  {
     case OSCILLATOR_BOUNCING:
       #ifndef GIF
         //  1) set oscillator acceleration from sensor readings
@@ -1236,7 +2392,7 @@ oscillator_update
         oscillator_speed.y    = -oscillator_speed.y ;
       }
 
-      grid_dist2osc_update( ) ;
+      //  5) grid_dist2osc_update( ) is left to oscillator_update( ), once per rendered frame.
 
       // 6) introduce some drag to dampen oscillator speed
       #ifndef GIF
@@ -1245,404 +2401,2330 @@ oscillator_update
       #endif
     break ;
 
+    case OSCILLATOR_ANCHORED:
+    case OSCILLATOR_FLOATING:
     case OSCILLATOR_UNDEFINED:
     break ;
   }
 }
 
 
+// Brings the oscillator phase and distances up to date with the simulation steps taken since the last frame, and with the
+// lattice lines if LOD moved them.
 void
-world_update
-( )
+oscillator_update
+( const bool isLatticeMoved )
 {
-  ++s_world_updateCount ;   //   "Master clock" for everything.
+  PROFILE_SCOPE( PROFILE_OSCILLATOR ) ;
 
-  oscillator_update( ) ;
-  grid_z_update( ) ;
-  camera_update( ) ;
-  grid_visibility_update( ) ;
+  oscillator_anglePhase = oscillator_phase( s_world_updateCount ) ;
 
-  // this will queue a defered call to the world_draw( ) method.
-  layer_mark_dirty( s_world_layer ) ;
+  switch (s_oscillator)
+  {
+    case OSCILLATOR_ANCHORED:
+      //  The oscillator is not moving: only the lines re-spaced by the LOD, following the cam, need their distances.
+#ifdef LOD
+      if (isLatticeMoved)
+        Lattice_dist2osc_lod_update( s_lattice, pattern_latticeView( s_pattern ) ) ;
+#endif
+    break ;
+
+    case OSCILLATOR_FLOATING:
+      position_setFromSensors( &oscillator_position ) ;
+      grid_dist2osc_update( ) ;
+    break ;
+
+    case OSCILLATOR_BOUNCING:
+      grid_dist2osc_update( ) ;
+    break ;
+
+    case OSCILLATOR_UNDEFINED:
+    break ;
+  }
+}
+
+
+/***  ---------------  Level of detail  ---------------  ***/
+
+#ifdef LOD
+  static Q        lod_mass  [GRID_LINES_MAX] ;   // Auxiliary arrays, per major cell of one axis.
+  static int32_t  lod_crest [GRID_LINES_MAX] ;
+  static Q        lod_target[GRID_LINES_MAX] ;
+
+
+  // Re-spaces the major lines of one axis, the lattice keeps its vertex count: each cell gets an equal share of detail,
+  // made of its width, its projected size (inverse of its distance to the cam) and, unless the oscillator is anchored,
+  // its height variation (last frame z). Returns true if any line moved.
+  bool
+  Lattice_lod_axis
+  ( Lattice    *l
+  , const bool  isAxisX
+  )
+  {
+    const int  n        = l->lines ;
+    int16_t   *coord    = isAxisX ? l->xCoord : l->yCoord ;
+    bool      *moved    = isAxisX ? lod_movedX : lod_movedY ;
+    const Q    camAxis  = isAxisX ? s_cam.viewPoint.x : s_cam.viewPoint.y ;
+    const Q    camOther = isAxisX ? s_cam.viewPoint.y : s_cam.viewPoint.x ;
+
+    // Squared cam distance to the grid, across the axis: a line's nearest point to the cam is on the grid's edge or facing it.
+    const Q camOutside  = (camOther > grid_halfScale) ? camOther - grid_halfScale : (camOther < -grid_halfScale) ? camOther + grid_halfScale : Q_0 ;
+    const Q camAcross2  = Q_mul( camOutside, camOutside ) + Q_mul( s_cam.viewPoint.z, s_cam.viewPoint.z ) ;
+
+    // The anchored oscillator's distances only need recomputing when its lines move: there they follow the cam only, not
+    // the crests travelling every frame.
+    const bool isCrestFollowed = (s_oscillator != OSCILLATOR_ANCHORED) ;
+
+    Q       camTotal   = Q_0 ;
+    int32_t crestTotal = 0 ;
+
+    for (int m = 0  ;  m < n-1  ;  ++m)
+    {
+      const Q a   = coord[2*m  ] << COORD_SHIFT ;
+      const Q b   = coord[2*m+2] << COORD_SHIFT ;
+      const Q mid = ((a + b) >> 1) - camAxis ;
+
+      camTotal += (lod_mass[m] = Q_div( b - a, Q_sqrt( Q_mul( mid, mid ) + camAcross2 ) )) ;
+
+      // Sum of the height steps across the cell, along the whole line.
+      int32_t crest = 0 ;
+
+      for (int k = 0  ;  isCrestFollowed  &&  k < n  ;  ++k)
+      {
+        const int dz = isAxisX ? l->z[Lattice_point( l, 2*m+2, k )] - l->z[Lattice_point( l, 2*m, k )]
+                               : l->z[Lattice_point( l, 2*k, m+1 )] - l->z[Lattice_point( l, 2*k, m )]
+                               ;
+        crest += (dz < 0) ? -dz : dz ;
+      }
+
+      crestTotal += (lod_crest[m] = crest) ;
+    }
+
+    // Flat surface, or crests not followed: the crest share goes to the even spacing.
+    const Q shareUniform = Q_from_float(LOD_SHARE_UNIFORM) + ((crestTotal == 0) ? Q_from_float(LOD_SHARE_CREST) : Q_0) ;
+    Q       massTotal    = Q_0 ;
+
+    for (int m = 0  ;  m < n-1  ;  ++m)
+    {
+      lod_mass[m] = Q_mul( shareUniform, Q_div( (coord[2*m+2] - coord[2*m]) << COORD_SHIFT, grid_scale ) )
+                  + Q_mul( Q_from_float(LOD_SHARE_CAM), Q_div( lod_mass[m], camTotal ) )
+                  + ((crestTotal == 0) ? Q_0 : Q_mul( Q_from_float(LOD_SHARE_CREST), Q_div( lod_crest[m], crestTotal ) ))
+                  ;
+      massTotal  += lod_mass[m] ;
+    }
+
+    // Line i goes where the running mass reaches i/(n-1) of the total, interpolating within the cell.
+    Q   massRunning = Q_0 ;
+    int m           = 0 ;
+
+    for (int i = 1  ;  i < n-1  ;  ++i)
+    {
+      const Q massTarget = (Q)(((int64_t)massTotal * i) / (n-1)) ;
+
+      while (m < n-2  &&  massRunning + lod_mass[m] < massTarget)
+        massRunning += lod_mass[m++] ;
+
+      lod_target[i] = (coord[2*m] << COORD_SHIFT)
+                    + Q_mul( (coord[2*m+2] - coord[2*m]) << COORD_SHIFT, Q_div( massTarget - massRunning, lod_mass[m] ) )
+                    ;
+    }
+
+    // Lines ease towards their targets, so that a travelling crest drags them smoothly, and stay put while within
+    // 1/2^LOD_DEADBAND_LEVEL of an even cell from it: a slowly moving cam does not move them every frame. End lines never
+    // move.
+    const int deadband = ((grid_scale >> COORD_SHIFT) / (n-1)) >> LOD_DEADBAND_LEVEL ;
+    bool      isMoved  = false ;
+
+    for (int i = 1  ;  i < n-1  ;  ++i)
+    {
+      const int delta = (lod_target[i] >> COORD_SHIFT) - coord[2*i] ;
+
+      if (delta > deadband  ||  delta < -deadband)
+      {
+        coord[2*i] += delta / (1 << LOD_SMOOTHING_LEVEL) ;
+        moved[2*i]  = isMoved = true ;
+      }
+    }
+
+    // Minor lines stay halfway between their major neighbours.
+    for (int c = 1  ;  c < 2*n - 1  ;  c += 2)
+      if (moved[c-1]  ||  moved[c+1])
+      {
+        coord[c] = (coord[c-1] + coord[c+1]) >> 1 ;
+        moved[c] = true ;
+      }
+
+    return isMoved ;
+  }
+#endif
+
+
+// Adapts the lattice line spacing to the cam and to the surface. Returns true if the lines moved, in which case the
+// distances to the oscillator are stale.
+bool
+grid_lod_update
+( )
+{
+#ifdef LOD
+  switch (s_pattern)
+  {
+    case PATTERN_DOTS:
+    case PATTERN_STRIPES:
+    case PATTERN_LINES:
+    case PATTERN_GRID:
+      {
+        const bool isMovedX = Lattice_lod_axis( s_lattice, true  ) ;
+        const bool isMovedY = Lattice_lod_axis( s_lattice, false ) ;
+
+        return isMovedX  ||  isMovedY ;
+      }
+
+    case PATTERN_RINGS:
+    case PATTERN_UNDEFINED:
+    break ;
+  }
+#endif
+
+  return false ;
+}
+
+
+static int  s_frame_chunksNum ;    // Per frame chunking stats.
+static int  s_frame_ms ;
+static int  s_frame_chunkMsMax ;
+static int  s_frame_steps ;
+
+static bool      s_frame_isClicked ;   // A click no complete frame has shown yet...
+static uint32_t  s_frame_clickMs ;     // ... and its wall clock.
+
+
+/***  ---------------  Simulation clock  ---------------  ***/
+
+// The world is simulated in fixed SIM_STEP_MS steps, as many as the wall clock elapsed since the last frame, so the
+// ripples keep the same pace whatever the frame computation time. Renders are paced apart by ANIMATION_INTERVAL_MS.
+
+static uint32_t  s_sim_lastMs ;        // Wall clock of the last time the accumulator was fed.
+static int       s_sim_accumMs ;       // Wall clock not yet consumed by simulation steps.
+static uint32_t  s_sim_dueMs ;         // Deadline of the next frame.
+static int       s_sim_stepsDropped ;  // Steps given up on to catch up with the wall clock, since the last report.
+
+static ActivityMode  s_activity_mode      = ACTIVITY_ACTIVE ;
+static int           s_activity_idleLevel = 0 ;      // Frames ANIMATION_INTERVAL_MS << s_activity_idleLevel apart.
+
+
+// (Re)starts the simulation clock, with one step pending for the first frame.
+void
+sim_clock_reset
+( )
+{
+  s_sim_lastMs  = s_sim_dueMs = Clock_ms( ) ;
+  s_sim_accumMs = SIM_STEP_MS ;
+}
+
+
+// Number of simulation steps due for this frame, at most SIM_STEPS_MAX: beyond that the frame computation can not
+// keep up and the time debt is written off rather than snowball.
+int
+sim_stepsDue
+( )
+{
+#if defined(GIF)  ||  defined(BENCH)
+  return 1 ;    // GIF and bench frames are exactly one step apart, whatever their computation time.
+#else
+  const uint32_t now = Clock_ms( ) ;
+
+  s_sim_accumMs += (int32_t)(now - s_sim_lastMs) ;
+  s_sim_lastMs   = now ;
+
+  int steps = s_sim_accumMs / SIM_STEP_MS ;
+
+  s_sim_accumMs -= steps * SIM_STEP_MS ;
+
+  // Idle frames are further apart by design, their steps are not a debt.
+  const int stepsMax = SIM_STEPS_MAX << s_activity_idleLevel ;
+
+  if (steps > stepsMax)
+  {
+    s_sim_stepsDropped += steps - stepsMax ;
+    steps = stepsMax ;
+  }
+
+  return steps ;
+#endif
+}
+
+
+// Advances the world state by one SIM_STEP_MS step.
+void
+sim_step
+( )
+{
+  ++s_world_updateCount ;   //   "Master clock" for everything.
+
+  oscillator_step( ) ;
+  camera_step( ) ;
+}
+
+
+// Delay until the next frame is due. Deadlines are kept on a fixed ANIMATION_INTERVAL_MS grid, so the frame
+// computation time does not add up to the period; a frame more than an interval late re-bases the grid on now.
+uint32_t
+sim_nextFrameDelay
+( )
+{
+  const uint32_t now      = Clock_ms( ) ;
+  const int      interval = ANIMATION_INTERVAL_MS << s_activity_idleLevel ;
+
+  s_sim_dueMs += interval ;
+
+  const int32_t delay = (int32_t)(s_sim_dueMs - now) ;
+
+  if (delay >= 0)
+    return delay ;
+
+  if (delay < -interval)
+    s_sim_dueMs = now ;
+
+  return 0 ;
+}
+
+
+#if defined(BENCH)  ||  defined(GOLDEN)
+  // Mode names, for the scenario ids.
+  static const char *s_patternNames     [] = { "", "dots", "lines", "stripes", "grid", "rings" } ;
+  static const char *s_transparencyNames[] = { "", "opaque", "translucent", "xray" } ;
+  static const char *s_oscillatorNames  [] = { "", "anchored", "floating", "bouncing" } ;
+  static const char *s_colorizationNames[] = { "", "mono", "signal", "dist", "light" } ;
+#endif
+
+
+#ifdef BENCH
+/***  ---------------  Benchmark  ---------------  ***/
+
+//  Every Pattern x Transparency x Oscillator x Colorization scenario for BENCH_FRAMES frames at BENCH_GRID_LINES, each
+//  replaying the stored trace's accelerometer samples and simulation steps from its start (looped, its clicks left out),
+//  so that two runs on the same trace do the exact same work. Each scenario logs one line:
+//    bench: {"id":"basalt/27/stripes/opaque/bouncing/light","unit":"ms","frames":28,"ticks":[...],"work":[...],"heap":n}
+//  ticks the oscillator, grid_z, camera, project, visibility and draw stage sums, work the f_XY, Q_div, Q_sqrt,
+//  occlusion test, probe, terminator step and segment sums, heap the most used over the scenario.
+
+  #define BENCH_PATTERNS        PBL_IF_COLOR_ELSE(5, 4)
+  #define BENCH_SCENARIOS       (BENCH_PATTERNS * 3 * 3 * 4)
+  #define BENCH_TICKS           6
+  #define BENCH_WORK            7
+
+  static int       s_bench_scenario = -1 ;    // Not started yet.
+  static int       s_bench_frame ;            // Frames into the scenario, warm up included.
+  static uint32_t  s_bench_ticks[BENCH_TICKS] ;
+  static uint32_t  s_bench_work [BENCH_WORK] ;
+  static size_t    s_bench_heapMax ;
+
+
+  void
+  bench_scenario_set
+  ( const int scenario )
+  {
+    int s = scenario ;
+
+    colorization_set( COLORIZATION_MONO       + s % 4 ) ;  s /= 4 ;
+    oscillatorMode_set( OSCILLATOR_ANCHORED   + s % 3 ) ;  s /= 3 ;
+    transparency_set( TRANSPARENCY_OPAQUE     + s % 3 ) ;  s /= 3 ;
+    pattern_set( PATTERN_DOTS + s ) ;
+    grid_resolution_set( BENCH_GRID_LINES ) ;    // Back from any lattice_set( ) fall back of the previous pattern.
+
+    Trace_replay_rewind( ) ;
+
+    s_bench_scenario = scenario ;
+    s_bench_frame    = 0 ;
+    s_bench_heapMax  = 0 ;
+
+    memset( s_bench_ticks, 0, sizeof(s_bench_ticks) ) ;
+    memset( s_bench_work , 0, sizeof(s_bench_work ) ) ;
+  }
+
+
+  void
+  bench_scenario_report
+  ( )
+  {
+    // Actual modes, pattern_set( ) falls back to LINES if the heap can not take the minor lattice.
+    APP_LOG( APP_LOG_LEVEL_INFO
+           , "bench: {\"id\":\"%s/%d/%s/%s/%s/%s\",\"unit\":\"%s\",\"frames\":%d"
+             ",\"ticks\":[%u,%u,%u,%u,%u,%u],\"work\":[%u,%u,%u,%u,%u,%u,%u],\"heap\":%u}"
+           , MEMORY_PLATFORM, s_grid_lines
+           , s_patternNames[s_pattern], s_transparencyNames[s_transparency]
+           , s_oscillatorNames[s_oscillator], s_colorizationNames[s_colorization]
+           , PROFILE_TICKS_UNIT, BENCH_FRAMES - BENCH_WARMUP_FRAMES
+           , (unsigned)s_bench_ticks[0], (unsigned)s_bench_ticks[1], (unsigned)s_bench_ticks[2]
+           , (unsigned)s_bench_ticks[3], (unsigned)s_bench_ticks[4], (unsigned)s_bench_ticks[5]
+           , (unsigned)s_bench_work[0], (unsigned)s_bench_work[1], (unsigned)s_bench_work[2], (unsigned)s_bench_work[3]
+           , (unsigned)s_bench_work[4], (unsigned)s_bench_work[5], (unsigned)s_bench_work[6]
+           , (unsigned)s_bench_heapMax
+           ) ;
+  }
+
+
+  // At the start of every frame, ahead of its replay: the next scenario once the current one has run its frames.
+  void
+  bench_frame_start
+  ( )
+  {
+    if (s_bench_scenario < 0)
+      bench_scenario_set( 0 ) ;
+    else if (s_bench_frame >= BENCH_FRAMES)
+    {
+      bench_scenario_report( ) ;
+
+      if (s_bench_scenario + 1 < BENCH_SCENARIOS)
+        bench_scenario_set( s_bench_scenario + 1 ) ;
+      else
+      {
+        APP_LOG( APP_LOG_LEVEL_INFO, "bench: %d scenarios done", BENCH_SCENARIOS ) ;
+        s_bench_scenario = BENCH_SCENARIOS ;
+      }
+    }
+  }
+
+
+  // Sums of the frame just drawn, ahead of the per frame stats reports that clear the counters.
+  void
+  bench_frame
+  ( )
+  {
+    uint32_t ticks[PROFILE_STAGES] ;
+
+    Profile_frame_take( ticks ) ;
+
+    if (s_bench_scenario < 0  ||  s_bench_scenario >= BENCH_SCENARIOS  ||  s_bench_frame++ < BENCH_WARMUP_FRAMES)
+      return ;
+
+    s_bench_ticks[0] += ticks[PROFILE_OSCILLATOR] ;
+    s_bench_ticks[1] += ticks[PROFILE_GRID_Z    ] ;
+    s_bench_ticks[2] += ticks[PROFILE_CAMERA    ] ;
+    s_bench_ticks[3] += ticks[PROFILE_PROJECT   ] ;
+    s_bench_ticks[4] += ticks[PROFILE_VISIBILITY] ;
+
+    for (int stage = PROFILE_DRAW_DOTS  ;  stage <= PROFILE_DRAW_RINGS  ;  ++stage)
+      s_bench_ticks[5] += ticks[stage] ;
+
+    s_bench_work[0] += s_work_fXYNum ;
+    s_bench_work[1] += s_work_divNum ;
+    s_bench_work[2] += s_work_sqrtNum ;
+    s_bench_work[3] += s_work_testsNum ;
+    s_bench_work[4] += s_work_probesNum ;
+    s_bench_work[5] += s_work_terminatorStepsNum ;
+    s_bench_work[6] += s_work_segmentsNum ;
+
+    if (heap_bytes_used( ) > s_bench_heapMax)
+      s_bench_heapMax = heap_bytes_used( ) ;
+  }
+#endif
+
+
+#ifdef GOLDEN
+/***  ---------------  Golden frames  ---------------  ***/
+
+//  Every Pattern x Transparency x Colorization scenario of the GIF mode, each restarted from s_world_updateCount 0 and
+//  the same state (see golden_frame_start( )), its frame buffer logged at the GOLDEN_COUNTS update counts:
+//    golden: frame <id> <width> <height> <bits per pixel>
+//    golden: <y> <byte offset> <runs, hex byte pairs: length - 1, value>
+//    golden: end <id>
+//  for tools/golden_compare.py to rebuild, save as golden or compare against the golden ones. A row takes as many lines
+//  of up to GOLDEN_LINE_RUNS runs as it needs, bytes outside the drawable range of the round display rows are left out.
+
+  #define GOLDEN_PATTERNS       PBL_IF_COLOR_ELSE(5, 4)
+  #define GOLDEN_SCENARIOS      (GOLDEN_PATTERNS * 3 * 4)
+  #define GOLDEN_LINE_RUNS      40
+
+  static const int  s_golden_counts[] = GOLDEN_COUNTS ;
+
+  #define GOLDEN_COUNTS_NUM     (int)(sizeof(s_golden_counts) / sizeof(s_golden_counts[0]))
+
+  static int  s_golden_scenario = -1 ;    // Not started yet.
+
+
+  // At the start of every frame: the next scenario once the current one is past its last golden frame. Every scenario
+  // starts from the same state, whatever ran before it: a new lattice (evenly spaced lines, no LOD, no visibility or light
+  // planes left over), the polar mesh cleared, every mode set up from undefined, the keyframes and cam rotation reset.
+  void
+  golden_frame_start
+  ( )
+  {
+    if (s_golden_scenario >= 0  &&  s_world_updateCount < s_golden_counts[GOLDEN_COUNTS_NUM - 1])
+      return ;
+
+    if (++s_golden_scenario >= GOLDEN_SCENARIOS)
+    {
+      APP_LOG( APP_LOG_LEVEL_INFO, "golden: %d scenarios done", GOLDEN_SCENARIOS ) ;
+      return ;
+    }
+
+  #ifdef GOLDEN_REVERSED
+    int s = GOLDEN_SCENARIOS - 1 - s_golden_scenario ;
+  #else
+    int s = s_golden_scenario ;
+  #endif
+
+    const Colorization colorization = COLORIZATION_MONO   + s % 4 ;  s /= 4 ;
+    const Transparency transparency = TRANSPARENCY_OPAQUE + s % 3 ;  s /= 3 ;
+    const Pattern      pattern      = PATTERN_DOTS + s ;
+
+    s_lattice      = Lattice_destroy( s_lattice ) ;
+    s_colorization = COLORIZATION_UNDEFINED ;
+    s_pattern      = PATTERN_UNDEFINED ;
+    s_oscillator   = OSCILLATOR_UNDEFINED ;
+    s_transparency = TRANSPARENCY_UNDEFINED ;
+
+  #ifdef PBL_COLOR
+    rings_num = RINGS_NUM ;
+    memset( rings_z         , 0, sizeof(rings_z         ) ) ;
+    memset( rings_visibility, 0, sizeof(rings_visibility) ) ;
+    memset( rings_screen    , 0, sizeof(rings_screen    ) ) ;
+    memset( rings_palette   , 0, sizeof(rings_palette   ) ) ;
+  #endif
+
+  #ifdef KEYFRAMES
+    s_keyframe_tick    = 0 ;
+    s_keyframe_isValid = false ;
+  #endif
+
+    s_world_updateCount   = 0 ;
+    oscillator_anglePhase = oscillator_phase( s_world_updateCount ) ;
+
+    // The oscillator back at its initial position first, the new lattice's distances, heights and visibility from there.
+    oscillatorMode_set( OSCILLATOR_DEFAULT ) ;
+    transparency_set( transparency ) ;
+    pattern_set( pattern ) ;
+    colorization_set( colorization ) ;
+  }
+
+
+  // Logs the frame buffer of the frame just drawn if it is one of the golden ones.
+  void
+  golden_dump
+  ( GContext *gCtx )
+  {
+    if (s_golden_scenario < 0  ||  s_golden_scenario >= GOLDEN_SCENARIOS)
+      return ;
+
+    bool isGolden = false ;
+
+    for (int c = 0  ;  c < GOLDEN_COUNTS_NUM  ;  ++c)
+      isGolden |= (s_world_updateCount == s_golden_counts[c]) ;
+
+    GBitmap *frameBuffer ;
+
+    if (!isGolden  ||  (frameBuffer = graphics_capture_frame_buffer( gCtx )) == NULL)
+      return ;
+
+    const GRect bounds = gbitmap_get_bounds( frameBuffer ) ;
+    const bool  is1Bit = (gbitmap_get_format( frameBuffer ) == GBitmapFormat1Bit) ;
+    char        id[64] ;
+
+    // Actual modes, pattern_set( ) falls back to LINES if the heap can not take the minor lattice.
+    snprintf( id, sizeof(id), "%s/%s/%s/%s/%d"
+            , MEMORY_PLATFORM, s_patternNames[s_pattern], s_transparencyNames[s_transparency]
+            , s_colorizationNames[s_colorization], s_world_updateCount
+            ) ;
+
+    APP_LOG( APP_LOG_LEVEL_INFO, "golden: frame %s %d %d %d", id, bounds.size.w, bounds.size.h, is1Bit ? 1 : 8 ) ;
+
+    for (int y = 0  ;  y < bounds.size.h  ;  ++y)
+    {
+      const GBitmapDataRowInfo rowInfo = gbitmap_get_data_row_info( frameBuffer, y ) ;
+      const int                xMin    = is1Bit ? rowInfo.min_x >> 3 : rowInfo.min_x ;
+      const int                xMax    = is1Bit ? rowInfo.max_x >> 3 : rowInfo.max_x ;
+
+      char line[4 * GOLDEN_LINE_RUNS + 1] ;
+      int  runsNum = 0 ;
+      int  offset  = xMin ;
+
+      for (int x = xMin  ;  x <= xMax  ;  )
+      {
+        const uint8_t value  = rowInfo.data[x] ;
+        int           length = 1 ;
+
+        while (x + length <= xMax  &&  length < 256  &&  rowInfo.data[x + length] == value)
+          ++length ;
+
+        snprintf( line + 4 * runsNum++, 5, "%02x%02x", length - 1, value ) ;
+        x += length ;
+
+        if (runsNum == GOLDEN_LINE_RUNS  ||  x > xMax)
+        {
+          APP_LOG( APP_LOG_LEVEL_INFO, "golden: %d %d %s", y, offset, line ) ;
+          runsNum = 0 ;
+          offset  = x ;
+        }
+      }
+    }
+
+    graphics_release_frame_buffer( gCtx, frameBuffer ) ;
+
+    APP_LOG( APP_LOG_LEVEL_INFO, "golden: end %s", id ) ;
+  }
+#endif
+
+
+#ifdef TRACE_REPLAY
+  void trace_click_dispatch( const uint8_t click ) ;
+#endif
+
+
+// Palette indices a mode change left stale, once the z and visibility they derive from are complete.
+void
+frame_palette_refresh
+( )
+{
+  if ((s_frame_dirty & FRAME_DIRTY_PALETTE) == 0)
+    return ;
+
+  grid_palette_update( ) ;
+  s_frame_dirty &= ~FRAME_DIRTY_PALETTE ;
+}
+
+
+// One resumable chunk of the frame computation, so that button clicks get serviced in between. Returns true once the
+// frame is complete.
+bool
+world_update_chunk
+( )
+{
+  // Inputs between the chunks of a frame, replayed at the same chunk.
+#if defined(TRACE_RECORD)
+  if (s_frame_stage != FRAME_STAGE_IDLE)
+    Trace_record_chunk( ) ;
+#elif defined(TRACE_REPLAY)
+  if (s_frame_stage != FRAME_STAGE_IDLE)
+    Trace_replay_chunk( trace_click_dispatch ) ;
+#endif
+
+  switch (s_frame_stage)
+  {
+    case FRAME_STAGE_IDLE:
+    {
+      // From here on the lattice is the next frame's. Renders that fell behind are skipped: their steps all land on
+      // this one.
+      s_frame_isDrawable = false ;
+
+#ifdef BENCH
+      bench_frame_start( ) ;
+#endif
+
+#ifdef TRACE_REPLAY
+      // Recorded steps, the simulation clock still kept up to date for the frame pacing. Live steps past the trace end,
+      // the bench loops the trace instead.
+      int       stepsNum = sim_stepsDue( ) ;
+      int       replayed = Trace_replay_frame( trace_click_dispatch ) ;
+
+  #ifdef BENCH
+      if (replayed < 0)
+      {
+        Trace_replay_rewind( ) ;
+        replayed = Trace_replay_frame( trace_click_dispatch ) ;
+      }
+  #endif
+
+      if (replayed >= 0)
+        stepsNum = replayed ;
+#else
+      const int stepsNum = sim_stepsDue( ) ;
+#endif
+
+#ifdef TRACE_RECORD
+      Trace_record_frame( stepsNum ) ;
+#endif
+
+#ifdef GOLDEN
+      golden_frame_start( ) ;
+#endif
+
+      for (int step = 0  ;  step < stepsNum  ;  ++step)
+        sim_step( ) ;
+
+      s_frame_steps = stepsNum ;
+
+#ifdef KEYFRAMES
+      if (keyframe_interpolate( ))
+      {
+        camera_update( ) ;
+        grid_screen_project( s_transparency == TRANSPARENCY_OPAQUE  ||  s_transparency == TRANSPARENCY_XRAY ) ;
+        frame_palette_refresh( ) ;
+
+        return true ;
+      }
+#endif
+
+      oscillator_update( grid_lod_update( ) ) ;
+
+      s_frame_stage = FRAME_STAGE_Z ;
+      s_frame_row   = 0 ;
+    }
+    break ;
+
+    case FRAME_STAGE_Z:
+      // Distances a mode change left stale, the oscillator not moving or the frame restarted past its idle stage.
+      if (s_frame_row == 0  &&  (s_frame_dirty & FRAME_DIRTY_DIST2OSC))
+      {
+        grid_dist2osc_update( ) ;
+        s_frame_dirty &= ~FRAME_DIRTY_DIST2OSC ;
+      }
+
+      if ((s_frame_row = grid_z_updateRows( s_frame_row, FRAME_CHUNK_ROWS * FRAME_Z_CHUNK_FACTOR )) == 0)
+        s_frame_stage = FRAME_STAGE_PROJECT ;
+    break ;
+
+    case FRAME_STAGE_PROJECT:
+      camera_update( ) ;
+      grid_screen_project( false ) ;      // Also culls off screen vertices, ahead of their occlusion tests.
+
+      s_frame_stage = FRAME_STAGE_VISIBILITY ;
+    break ;
+
+    case FRAME_STAGE_VISIBILITY:
+      if ((s_frame_row = grid_visibility_updateRows( s_frame_row, FRAME_CHUNK_ROWS )) == 0)
+      {
+        frame_palette_refresh( ) ;
+
+        s_frame_stage = FRAME_STAGE_IDLE ;
+        return true ;
+      }
+    break ;
+  }
+
+  return false ;
+}
+
+
+// Accounts a chunk's duration, the longest one bounds the button click latency.
+void
+frame_stats_chunk
+( const int ms )
+{
+  ++s_frame_chunksNum ;
+  s_frame_ms += ms ;
+  activity_cpu( ms ) ;
+
+  if (ms > s_frame_chunkMsMax)
+    s_frame_chunkMsMax = ms ;
+}
+
+
+void
+frame_stats_report
+( )
+{
+  LOGD( "frame:: %d chunks, %d ms, longest chunk %d ms", s_frame_chunksNum, s_frame_ms, s_frame_chunkMsMax ) ;
+
+  LOGD( "frame:: %d simulation steps, %d dropped", s_frame_steps, s_sim_stepsDropped ) ;
+
+#if defined(LOG)  &&  !defined(GIF)
+  Accel_stats_report( ) ;
+#endif
+
+  s_frame_chunksNum = s_frame_ms = s_frame_chunkMsMax = s_sim_stepsDropped = 0 ;
+}
+
+
+// A frame without simulation steps, for the modes changed since the last one. Invalidated first, from the idle stage:
+// keyframe heights of another phase are not to be interpolated from.
+void
+frame_refresh_start
+( )
+{
+  grid_projection_invalidate( ) ;
+
+  s_frame_stage = FRAME_STAGE_Z ;
+  s_frame_row   = 0 ;
+}
+
+
+// Stamps a click for its latency, and makes sure a frame follows it: the one under way, the next one due, or else one
+// started right away without simulation steps (frames stopped at the end of a GIF or of the bench).
+void
+frame_click
+( )
+{
+  if (!s_frame_isClicked)
+  {
+    s_frame_isClicked = true ;
+    s_frame_clickMs   = Clock_ms( ) ;
+  }
+
+  if (s_frame_stage != FRAME_STAGE_IDLE  ||  s_world_updateTimer_ptr != NULL  ||  s_frame_isDrawDue  ||  s_frame_isInChunk
+  ||  s_activity_mode == ACTIVITY_OBSCURED)
+    return ;
+
+  frame_refresh_start( ) ;
+  s_world_updateTimer_ptr = app_timer_register( 0, world_update_timer_handler, NULL ) ;
+}
+
+
+// End of a world_draw( ) of a complete frame: the first one to show the pending click, whatever the frame computation,
+// chunk waits and draw it took.
+void
+frame_stats_drawn
+( )
+{
+  if (!s_frame_isClicked)
+    return ;
+
+  s_frame_isClicked = false ;
+
+  LOGD( "click:: %d ms from the click handler to the end of world_draw( )", (int)(Clock_ms( ) - s_frame_clickMs) ) ;
+}
+
+
+// Arms the timer of the next frame's first chunk.
+void
+world_update_schedule
+( )
+{
+#ifdef GIF
+  if (s_world_updateCount >= GIF_STOP_COUNT)
+    return ;
+#endif
+
+#ifdef BENCH
+  if (s_bench_scenario >= BENCH_SCENARIOS)
+    return ;
+#endif
+
+#ifdef GOLDEN
+  if (s_golden_scenario >= GOLDEN_SCENARIOS)
+    return ;
+#endif
+
+  // Already armed by a GIF stepper click.
+  if (s_world_updateTimer_ptr != NULL)
+    return ;
+
+  activity_update( ) ;
+
+  if (s_activity_mode == ACTIVITY_OBSCURED)
+    return ;
+
+  s_world_updateTimer_ptr = app_timer_register( sim_nextFrameDelay( ), world_update_timer_handler, NULL ) ;
+}
+
+
+/***  ---------------  Activity  ---------------  ***/
+
+// Frame production follows the user's attention: none while the app is obscured, halved frame rates while nothing
+// moves, the full frame rate back on any button, tap or wrist movement.
+
+static int        s_activity_stillFrames ;             // Consecutive frames with nothing moving.
+static AccelSample  s_activity_accelRef ;              // Accelerometer reading at the last wake up.
+static uint32_t   s_activity_modeSinceMs ;             // Wall clock of the last mode change.
+static uint32_t   s_activity_cpuMs [ACTIVITY_MODES] ;  // Frame computation and drawing time spent in each mode...
+static uint32_t   s_activity_wallMs[ACTIVITY_MODES] ;  // ... over the wall clock time spent in each mode, until the last mode change.
+
+
+// Accounts frame computation or drawing time to the current mode.
+void
+activity_cpu
+( const int ms )
+{ s_activity_cpuMs[s_activity_mode] += ms ; }
+
+
+// Battery relevant CPU time per hour of each mode so far.
+void
+activity_report
+( )
+{
+#ifdef LOG
+  static const char *modeNames[ACTIVITY_MODES] = { "active", "idle", "obscured" } ;
+
+  for (int mode = 0  ;  mode < ACTIVITY_MODES  ;  ++mode)
+  {
+    const uint32_t wallMs = s_activity_wallMs[mode]
+                          + ((mode == (int)s_activity_mode) ? Clock_ms( ) - s_activity_modeSinceMs : 0)
+                          ;
+    if (wallMs > 0)
+      LOGD( "activity:: %s %u s, %u ms CPU, %u ms CPU per hour"
+          , modeNames[mode]
+          , (unsigned)(wallMs / 1000)
+          , (unsigned)s_activity_cpuMs[mode]
+          , (unsigned)((uint64_t)s_activity_cpuMs[mode] * 3600000 / wallMs)
+          ) ;
+  }
+#endif
+}
+
+
+void
+activity_mode_set
+( const ActivityMode mode )
+{
+  if (s_activity_mode == mode)
+    return ;
+
+  const uint32_t now = Clock_ms( ) ;
+
+  s_activity_wallMs[s_activity_mode] += now - s_activity_modeSinceMs ;
+  s_activity_modeSinceMs              = now ;
+  s_activity_mode                     = mode ;
+
+  activity_report( ) ;
+}
+
+
+// Back to the full frame rate, the next frame right away if the current one is already done.
+void
+activity_wake
+( )
+{
+  s_activity_stillFrames = 0 ;
+
+#ifndef GIF
+  Accel_latest( &s_activity_accelRef ) ;
+#endif
+
+  if (s_activity_mode != ACTIVITY_IDLE)
+    return ;
+
+  activity_mode_set( ACTIVITY_ACTIVE ) ;
+  s_activity_idleLevel = 0 ;
+
+  if (s_frame_stage == FRAME_STAGE_IDLE  &&  s_world_updateTimer_ptr != NULL)
+  {
+    // Waiting out an idle frame interval: due now instead.
+    app_timer_cancel( s_world_updateTimer_ptr ) ;
+
+    s_sim_dueMs             = Clock_ms( ) ;
+    s_world_updateTimer_ptr = app_timer_register( 0, world_update_timer_handler, NULL ) ;
+  }
+  else
+    s_sim_dueMs = Clock_ms( ) - ANIMATION_INTERVAL_MS ;   // The next deadline is now.
+}
+
+
+// Once per complete frame: wakes up on wrist movements, ramps the frame rate down after ACTIVITY_IDLE_FRAMES still
+// frames in a row.
+void
+activity_update
+( )
+{
+#ifndef GIF
+  AccelSample ad ;
+
+  const bool isAccelStill = !Accel_latest( &ad )
+                         || abs( ad.x - s_activity_accelRef.x )
+                          + abs( ad.y - s_activity_accelRef.y )
+                          + abs( ad.z - s_activity_accelRef.z ) <= ACTIVITY_ACCEL_THRESHOLD
+                          ;
+
+  const bool isOscillatorStill = (s_oscillator != OSCILLATOR_BOUNCING)
+                              || abs( oscillator_speed.x ) + abs( oscillator_speed.y ) < ACTIVITY_SPEED_EPSILON
+                               ;
+
+  if (!isAccelStill  ||  !isOscillatorStill)
+  {
+    activity_wake( ) ;
+    return ;
+  }
+
+  if (++s_activity_stillFrames < ACTIVITY_IDLE_FRAMES  ||  s_activity_idleLevel == ACTIVITY_IDLE_LEVEL_MAX)
+    return ;
+
+  s_activity_stillFrames = 0 ;
+  ++s_activity_idleLevel ;
+
+  activity_mode_set( ACTIVITY_IDLE ) ;
+  LOGD( "activity:: idle, frames %d ms apart", ANIMATION_INTERVAL_MS << s_activity_idleLevel ) ;
+#endif
+}
+
+
+#ifndef GIF
+  // Focus lost to a notification or a system menu: frames stop until it comes back.
+  void
+  app_focus_handler
+  ( const bool isInFocus )
+  {
+    if (!isInFocus)
+    {
+      if (s_world_updateTimer_ptr != NULL)
+      {
+        app_timer_cancel( s_world_updateTimer_ptr ) ;
+        s_world_updateTimer_ptr = NULL ;
+      }
+
+      activity_mode_set( ACTIVITY_OBSCURED ) ;
+      return ;
+    }
+
+    if (s_activity_mode != ACTIVITY_OBSCURED)
+      return ;
+
+    activity_mode_set( ACTIVITY_ACTIVE ) ;
+    s_activity_idleLevel = 0 ;
+    activity_wake( ) ;
+
+    // Resumes where it stopped, the frame halfway through included, the time spent obscured written off.
+    sim_clock_reset( ) ;
+
+    if (s_world_updateTimer_ptr == NULL)
+      s_world_updateTimer_ptr = app_timer_register( 0, world_update_timer_handler, NULL ) ;
+  }
+
+
+  void
+  accel_tap_handler
+  ( AccelAxisType axis
+  , int32_t       direction
+  )
+  { activity_wake( ) ; }
+#endif
+
+
+// The lattice state is a complete frame's, for world_draw( ).
+void
+frame_complete
+( )
+{
+  s_frame_isDrawable = true ;
+
+  frame_stats_report( ) ;
+}
+
+
+// Completes the frame under way, or recomputes the modes changed since the last one, for a world_draw( ) without a
+// snapshot of the last complete frame to fall back on (heap too short for it, or none drawn yet).
+void
+world_update_finish
+( )
+{
+  if (s_frame_isDrawable)
+    return ;
+
+  // The next frame keeps its timer and its simulation steps.
+  if (s_frame_stage == FRAME_STAGE_IDLE)
+    frame_refresh_start( ) ;
+  else
+  {
+    if (s_world_updateTimer_ptr != NULL)
+    {
+      app_timer_cancel( s_world_updateTimer_ptr ) ;
+      s_world_updateTimer_ptr = NULL ;
+    }
+
+    s_frame_isDrawDue = true ;
+  }
+
+  const uint32_t start = Clock_ms( ) ;
+
+  while (!world_update_chunk( ))
+    ;
+
+  frame_stats_chunk( Clock_ms( ) - start ) ;
+  frame_complete( ) ;
+}
+
+
+#ifdef RASTER
+  static bool  s_raster_isActive = false ;   // Draw straight into the frame buffer captured for this world_draw( ).
+#endif
+
+
+void
+function_draw_pixel
+( GContext    *gCtx
+, const Fuxel  f
+)
+{
+#ifdef RASTER
+  if (s_raster_isActive)
+  {
+  #ifdef PBL_COLOR
+    Raster_pixel( f.screen.x, f.screen.y, get_stroke_color( f ) ) ;
+  #else
+    Raster_pixel( f.screen.x, f.screen.y, s_color_stroke ) ;
+  #endif
+    return ;
+  }
+#endif
+
+#ifdef PBL_COLOR
+  set_stroke_color( gCtx, f ) ;
+#endif
+
+  graphics_draw_pixel( gCtx, f.screen ) ;
+}
+
+
+// Fuxel of point k of lattice row r.
+inline
+static
+void
+Lattice_fuxel
+( Fuxel         *f
+, const Lattice *l
+, const int      r
+, const int      k
+)
+{
+  const int rk = Lattice_point( l, r, k ) ;
+
+  f->world        = (Q3){ .x = l->xCoord[r] << COORD_SHIFT
+                        , .y = l->yCoord[2*k + (r & 1)] << COORD_SHIFT
+                        , .z = l->z[rk] << Z_SHIFT
+                        } ;
+  f->dist2osc     = l->dist2osc[rk] << DIST_SHIFT ;
+  f->visibility   = visibility_get( Lattice_visibilityRow( l, r ), l->words, k ) ;
+  f->paletteIndex = palette_row_get( Lattice_paletteRow( l, r ), l->words, k ) ;
+  f->screen       = screen_load( l->screen[rk], f->world ) ;
+}
+
+
+// Points of the view visible from the cam, all major rows then all minor rows.
+void
+Lattice_drawPixel
+( GContext          *gCtx
+, const Lattice     *l
+, const LatticeView  view
+)
+{
+  // Visible points only: iterate the set bits of the cam plane, fully hidden rows are skipped.
+  for (int parity = 0  ;  parity < (int)view  ;  ++parity)
+    for (int r = parity  ;  r < Lattice_size( l )  ;  r += 2)
+    {
+      const uint32_t *fromCam = Lattice_visibilityRow( l, r ) + VISIBILITY_FROM_CAM * l->words ;
+      const uint32_t *culled  = Lattice_visibilityRow( l, r ) + VISIBILITY_CULLED   * l->words ;
+
+      for (int w = 0  ;  w < l->words  ;  ++w)
+        for (uint32_t todo = fromCam[w] & ~culled[w]  ;  todo != 0u  ;  todo &= todo - 1)
+        {
+          Fuxel f ;  Lattice_fuxel( &f, l, r, (w << 5) + __builtin_ctz( todo ) ) ;
+
+          function_draw_pixel( gCtx, f ) ;
+        }
+    }
+}
+
+
+void
+Lattice_drawPixel_XRAY
+( GContext          *gCtx
+, const Lattice     *l
+, const LatticeView  view
+)
+{
+  // Hidden points only: iterate the set bits of the inverted cam plane, fully visible rows are skipped.
+  for (int parity = 0  ;  parity < (int)view  ;  ++parity)
+    for (int r = parity  ;  r < Lattice_size( l )  ;  r += 2)
+    {
+      const uint32_t *fromCam = Lattice_visibilityRow( l, r ) + VISIBILITY_FROM_CAM * l->words ;
+      const uint32_t *culled  = Lattice_visibilityRow( l, r ) + VISIBILITY_CULLED   * l->words ;
+
+      for (int w = 0  ;  w < l->words  ;  ++w)
+        for (uint32_t todo = ~(fromCam[w] | culled[w]) & bits_mask( Lattice_rowLength( l, r ), w )  ;  todo != 0u  ;  todo &= todo - 1)
+        {
+          Fuxel f ;  Lattice_fuxel( &f, l, r, (w << 5) + __builtin_ctz( todo ) ) ;
+
+          function_draw_pixel( gCtx, f ) ;
+        }
+    }
+}
+
+
+#ifdef HEATMAP
+  // Probes of a full occlusion test: 1 for the whole segment, then 2^(i-1) more for each halving i of the step.
+  #define HEATMAP_PROBES_FULL   (1 << VISIBILITY_MAX_ITERATIONS)
+
+
+  // Every on screen point of the view as a 2x2 block, colored from s_colorMap[0] for no probes at all up to
+  // s_colorMap[7] for a full occlusion test or more.
+  void
+  Lattice_drawHeatmap
+  ( GContext          *gCtx
+  , const Lattice     *l
+  , const LatticeView  view
+  )
+  {
+    for (int parity = 0  ;  parity < (int)view  ;  ++parity)
+      for (int r = parity  ;  r < Lattice_size( l )  ;  r += 2)
+      {
+        const uint32_t *culled = Lattice_visibilityRow( l, r ) + VISIBILITY_CULLED * l->words ;
+
+        for (int k = 0  ;  k < Lattice_rowLength( l, r )  ;  ++k)
+        {
+          if ((culled[k >> 5] >> (k & 31)) & 1)
+            continue ;
+
+          Fuxel f ;  Lattice_fuxel( &f, l, r, k ) ;
+
+          const int    probes = l->probes[Lattice_point( l, r, k )] ;
+          const GColor color  = s_colorMap[(probes < HEATMAP_PROBES_FULL) ? probes * 7 / HEATMAP_PROBES_FULL : 7] ;
+
+  #ifdef RASTER
+          if (s_raster_isActive)
+          {
+            Raster_pixel( f.screen.x    , f.screen.y    , color ) ;
+            Raster_pixel( f.screen.x + 1, f.screen.y    , color ) ;
+            Raster_pixel( f.screen.x    , f.screen.y + 1, color ) ;
+            Raster_pixel( f.screen.x + 1, f.screen.y + 1, color ) ;
+            continue ;
+          }
+  #endif
+
+          graphics_context_set_fill_color( gCtx, color ) ;
+          graphics_fill_rect( gCtx, GRect( f.screen.x, f.screen.y, 2, 2 ), 0, GCornerNone ) ;
+        }
+      }
+  }
+#endif
+
+
+/***  ---------------  Polyline batching  ---------------  ***/
+
+//  Consecutive segments sharing end points and stroke are drawn as a single open polyline.
+//  A run is broken by a visibility terminator (the next segment no longer starts where the previous ended) or a stroke change.
+//  On B&W the runs are still drawn a segment at a time (see polyline_flush( )): batching only saves draw calls on color.
+
+#define POLYLINE_POINTS_MAX   32
+
+static GPoint   s_polyline_points[POLYLINE_POINTS_MAX] ;
+static int      s_polyline_pointsNum = 0 ;
+
+#ifdef PBL_COLOR
+  static GColor s_polyline_stroke ;
+#else
+  static ink_t  s_polyline_stroke ;
+#endif
+
+// Per frame draw statistics.
+static int      s_polyline_rowsNum, s_polyline_segmentsNum, s_polyline_drawCallsNum, s_polyline_rowDrawCallsMax ;
+static int      s_polyline_rowDrawCalls ;
+
+
+void
+polyline_flush
+( GContext *gCtx )
+{
+  const int pointsNum = s_polyline_pointsNum ;
+
+  s_polyline_pointsNum = 0 ;
+
+  if (pointsNum < 2)
+    return ;
+
+  ++s_polyline_rowDrawCalls ;
+
+#ifdef RASTER
+  if (s_raster_isActive)
+  {
+  #ifdef PBL_COLOR
+    Raster_polyline( s_polyline_points, pointsNum, s_polyline_stroke, INK100 ) ;
+  #else
+    Raster_polyline( s_polyline_points, pointsNum, s_color_stroke, s_polyline_stroke ) ;
+  #endif
+    return ;
+  }
+#endif
+
+#ifdef PBL_COLOR
+  // Solid runs always go through gpath, whatever their length: single segments then cover the same pixels as longer runs.
+  graphics_context_set_stroke_color( gCtx, s_polyline_stroke ) ;
+
+  gpath_draw_outline_open( gCtx, &(GPath){ .num_points = pointsNum, .points = s_polyline_points } ) ;
+#else
+  // Every ink through Draw2D, segment by segment: the 1 bit pixels stay those of the unbatched rows, solid ones included
+  // (gpath lights other pixels). Draw2D has no polyline equivalent.
+  s_polyline_rowDrawCalls += pointsNum - 2 ;
+
+  for (int p = 1  ;  p < pointsNum  ;  ++p)
+    Draw2D_line_pattern( gCtx
+                       , s_polyline_points[p-1].x, s_polyline_points[p-1].y
+                       , s_polyline_points[p  ].x, s_polyline_points[p  ].y
+                       , s_polyline_stroke
+                       ) ;
+#endif
+}
+
+
+void
+polyline_segment
+( GContext     *gCtx
+, const GPoint  p0
+, const GPoint  p1
+#ifdef PBL_COLOR
+, const GColor  stroke
+#else
+, const ink_t   stroke
+#endif
+)
+{
+  ++s_polyline_segmentsNum ;
+
+  if ( s_polyline_pointsNum > 0
+    && s_polyline_pointsNum < POLYLINE_POINTS_MAX
+    && gpoint_equal( &s_polyline_points[s_polyline_pointsNum-1], &p0 )
+  #ifdef PBL_COLOR
+    && gcolor_equal( s_polyline_stroke, stroke )
+  #else
+    && s_polyline_stroke == stroke
+  #endif
+     )
+  {
+    s_polyline_points[s_polyline_pointsNum++] = p1 ;
+    return ;
+  }
+
+  polyline_flush( gCtx ) ;
+
+  s_polyline_stroke    = stroke ;
+  s_polyline_points[0] = p0 ;
+  s_polyline_points[1] = p1 ;
+  s_polyline_pointsNum = 2 ;
+}
+
+
+// To be called at the end of each grid row/column: flushes the pending run and accounts the row's draw calls.
+void
+polyline_rowEnd
+( GContext *gCtx )
+{
+  polyline_flush( gCtx ) ;
+
+  ++s_polyline_rowsNum ;
+  s_polyline_drawCallsNum += s_polyline_rowDrawCalls ;
+
+  if (s_polyline_rowDrawCalls > s_polyline_rowDrawCallsMax)
+    s_polyline_rowDrawCallsMax = s_polyline_rowDrawCalls ;
+
+  s_polyline_rowDrawCalls = 0 ;
+}
+
+
+void
+polyline_stats_report
+( )
+{
+  LOGD( "polyline:: %d rows, %d segments, %d draw calls, max %d draw calls per row"
+      , s_polyline_rowsNum, s_polyline_segmentsNum, s_polyline_drawCallsNum, s_polyline_rowDrawCallsMax
+      ) ;
+
+  s_polyline_rowsNum = s_polyline_segmentsNum = s_polyline_drawCallsNum = s_polyline_rowDrawCallsMax = 0 ;
+}
+
+
+void
+function_draw_line
+( GContext    *gCtx
+, const Fuxel  f0
+, const Fuxel  f1
+)
+{
+  if (!f0.visibility.fromCam && !f1.visibility.fromCam)    //  None of the points is visible ?
+    return ;
+
+  Fuxel  draw0, draw1 ;
+
+  if (f0.visibility.fromCam && f1.visibility.fromCam)      //  Both points visible ?
+  {
+    draw0 = f0 ;
+    draw1 = f1 ;
+  }
+  else                                   //  Only one of the points is visible.
+  {
+    Fuxel  terminator, invisible ;
+
+    if (f0.visibility.fromCam)
+    {
+      terminator = draw0 = f0 ;
+      invisible          = f1 ;
+    }
+    else
+    {
+      terminator = draw0 = f1 ;
+      invisible          = f0 ;
+    }
+
+    for (int i = 0  ;  i < TERMINATOR_MAX_ITERATIONS  ;  ++i)    // TODO: replace with a while with screen point distance exit heuristic.
+    {
+      WORK_COUNT( s_work_terminatorStepsNum ) ;
+
+      Fuxel  half ;
+
+      half.world.x            = (terminator.world.x + invisible.world.x) >> 1 ;
+      half.world.y            = (terminator.world.y + invisible.world.y) >> 1 ;
+      half.dist2osc           = oscillator_distance( half.world.x, half.world.y ) ;
+      half.world.z            = f_distance( half.dist2osc ) ;
+      half.visibility.fromCam = function_isVisible_fromPoint( half.world, s_cam.viewPoint, s_cam_viewPoint_boxing ) ;
+
+      if (half.visibility.fromCam)
+        terminator = half ;
+      else
+        invisible  = half ;
+    }
+
+    screen_project( &terminator.screen, terminator.world ) ;
+    draw1 = terminator ;
+  }
+
+  WORK_COUNT( s_work_segmentsNum ) ;
+
+#ifdef PBL_COLOR
+  polyline_segment( gCtx, draw0.screen, draw1.screen, get_stroke_color( draw0 ) ) ;
+#else
+  polyline_segment( gCtx, draw0.screen, draw1.screen, get_stroke_ink( draw0 ) ) ;
+#endif
+}
+
+
+// Lattice segment, trivially rejected if entirely off screen.
+inline
+static
+void
+Lattice_drawSegment
+( GContext    *gCtx
+, const Fuxel  f0
+, const Fuxel  f1
+)
+{
+  if (screen_outcode( f0.screen ) & screen_outcode( f1.screen ))
+    ++s_cull_segmentsNum ;
+  else
+    function_draw_line( gCtx, f0, f1 ) ;
+}
+
+
+// x parallel line at lattice column c, through the rows of the same parity.
+void
+Lattice_drawColumn
+( GContext      *gCtx
+, const Lattice *l
+, const int      c
+)
+{
+  const int k = c >> 1 ;
+  Fuxel     f0, f1 ;
+
+  Lattice_fuxel( &f1, l, c & 1, k ) ;
+
+  for (int r = (c & 1) + 2  ;  r < Lattice_size( l ) - 2  ;  r += 2)
+  {
+    f0 = f1 ;
+    Lattice_fuxel( &f1, l, r, k ) ;
+
+    Lattice_drawSegment( gCtx, f0, f1 ) ;
+  }
+
+  polyline_rowEnd( gCtx ) ;
+}
+
+
+// y parallel line at lattice row r.
+void
+Lattice_drawRow
+( GContext      *gCtx
+, const Lattice *l
+, const int      r
+)
+{
+  // Fully hidden row: no segment can be drawn.
+  if (bits_isZero( Lattice_visibilityRow( l, r ) + VISIBILITY_FROM_CAM * l->words, l->words ))
+    return ;
+
+  Fuxel f0, f1 ;
+
+  Lattice_fuxel( &f1, l, r, 0 ) ;
+
+  for (int k = 1  ;  k < Lattice_rowLength( l, r ) - 1  ;  ++k)
+  {
+    f0 = f1 ;
+    Lattice_fuxel( &f1, l, r, k ) ;
+
+    Lattice_drawSegment( gCtx, f0, f1 ) ;
+  }
+
+  polyline_rowEnd( gCtx ) ;
+}
+
+
+// All the x parallel lines of one parity: the major lines (0) or the minor lines (1).
+void
+Lattice_drawColumns
+( GContext      *gCtx
+, const Lattice *l
+, const int      parity
+)
+{
+  // Columns with at least one point visible, fully hidden columns have no segment to draw.
+  uint32_t fromCam[GRID_WORDS_MAX] = { 0u } ;
+
+  for (int r = parity  ;  r < Lattice_size( l )  ;  r += 2)
+    for (int w = 0  ;  w < l->words  ;  ++w)
+      fromCam[w] |= Lattice_visibilityRow( l, r )[VISIBILITY_FROM_CAM * l->words + w] ;
+
+  for (int k = 0  ;  k < Lattice_rowLength( l, parity )  ;  ++k)
+    if (bits_get( fromCam, k ))
+      Lattice_drawColumn( gCtx, l, 2*k + parity ) ;
+}
+
+
+// All the major y parallel lines.
+void
+Lattice_drawRows
+( GContext      *gCtx
+, const Lattice *l
+)
+{
+  for (int r = 0  ;  r < Lattice_size( l )  ;  r += 2)
+    Lattice_drawRow( gCtx, l, r ) ;
+}
+
+
+static uint8_t  cull_outcodes[3][GRID_LINES_MAX] ;   // Auxiliary array, rolling outcodes of 3 consecutive rows of the same parity.
+
+
+// Culled plane of lattice row r: off screen points whose lattice neighbours (same row, and the rows of the same parity
+// before and after, NULL if none) lie past a same outer half plane, so no segment through them can reach the screen.
+// The points back from culled get their occlusion tests if isUncoveredTested, their visibility being stale otherwise.
+void
+Lattice_cullRow
+( Lattice       *l
+, const int      r
+, const uint8_t *prev
+, const uint8_t *cur
+, const uint8_t *next
+, const bool     isUncoveredTested
+)
+{
+  const int  length       = Lattice_rowLength( l, r ) ;
+  uint32_t  *culled       = Lattice_visibilityRow( l, r ) + VISIBILITY_CULLED * l->words ;
+  uint32_t   uncoveredAny = 0u ;
+
+  for (int w = 0  ;  w < l->words  ;  ++w)
+  {
+    uint32_t word = 0u ;
+
+    for (int b = 0, k = w << 5  ;  b < 32  &&  k < length  ;  ++b, ++k)
+    {
+      const uint8_t outcode = cur[k] ;
+
+      if ( outcode != 0
+        && (k == 0         ||  (outcode & cur[k-1]))
+        && (k == length-1  ||  (outcode & cur[k+1]))
+        && (prev == NULL   ||  (outcode & prev[k]))
+        && (next == NULL   ||  (outcode & next[k]))
+         )
+      {
+        word |= 1u << b ;
+        ++s_cull_verticesNum ;
+      }
+    }
+
+    const uint32_t uncovered = culled[w] & ~word ;
+
+    culled[w] = word ;
+
+    if (isUncoveredTested  &&  uncovered != 0u)
+      Lattice_visibility_updateWord( l, r, w, uncovered ) ;
+
+    uncoveredAny |= uncovered ;
+  }
+
+  if (isUncoveredTested  &&  uncoveredAny != 0u  &&  s_colorization == COLORIZATION_LIGHT)
+    palette_row_setPlane( Lattice_paletteRow( l, r ), l->words, Lattice_visibilityRow( l, r ) + VISIBILITY_FROM_LIGHT1 * l->words ) ;
 }
 
 
 void
-function_draw_pixel
-( GContext    *gCtx
-, const Fuxel  f
+Lattice_screen_project
+( Lattice           *l
+, const LatticeView  view
+, const bool         isUncoveredTested
 )
 {
-#ifdef PBL_COLOR
-  set_stroke_color( gCtx, f ) ;
-#endif
+  const int size = Lattice_size( l ) ;
 
-  graphics_draw_pixel( gCtx, f.screen ) ;
+  // Rows of each parity in order, so that a row is culled once the next one is projected.
+  for (int parity = 0  ;  parity < (int)view  ;  ++parity)
+  {
+    const uint8_t *prev = NULL ;
+    const uint8_t *cur  = NULL ;
+
+    for (int r = parity  ;  r < size + 2  ;  r += 2)
+    {
+      uint8_t *next = NULL ;
+
+      if (r < size)
+      {
+        const Q lattice_x_r = l->xCoord[r] << COORD_SHIFT ;
+
+        next = cull_outcodes[(r >> 1) % 3] ;
+
+        for (int k = 0  ;  k < Lattice_rowLength( l, r )  ;  ++k)
+          next[k] = screen_outcode( screen_store( &l->screen[Lattice_point( l, r, k )]
+                                                , (Q3){ .x = lattice_x_r
+                                                      , .y = l->yCoord[2*k + (r & 1)] << COORD_SHIFT
+                                                      , .z = l->z[Lattice_point( l, r, k )] << Z_SHIFT
+                                                      }
+                                                )
+                                  ) ;
+      }
+
+      if (cur != NULL)
+        Lattice_cullRow( l, r - 2, prev, cur, next, isUncoveredTested ) ;
+
+      prev = cur ;
+      cur  = next ;
+    }
+  }
 }
 
 
+// Screen points and culling of the displayed pattern. With isUncoveredTested, frames that keep the last visibility
+// (KEYFRAMES in-between frames) test the vertices the cam brings back on screen, hidden from it until then.
 void
-grid_major_drawPixel
-( GContext *gCtx )
+grid_screen_project
+( const bool isUncoveredTested )
 {
-  for (int i = 0  ;  i < GRID_LINES  ;  ++i)
-    for (int j = 0  ;  j < GRID_LINES  ;  ++j)
+  PROFILE_SCOPE( PROFILE_PROJECT ) ;
+
+  switch (s_pattern)
+  {
+    case PATTERN_DOTS:
+    case PATTERN_STRIPES:
+    case PATTERN_LINES:
+    case PATTERN_GRID:
+      Lattice_screen_project( s_lattice, pattern_latticeView( s_pattern ), isUncoveredTested ) ;
+    break ;
+
+    case PATTERN_RINGS:
+#ifdef PBL_COLOR
+      rings_screen_project( ) ;
+#endif
+    break ;
+
+    case PATTERN_UNDEFINED:
+    break ;
+  }
+
+  s_grid_isProjected = true ;
+}
+
+
+#ifdef PBL_COLOR
+  void
+  rings_screen_project
+  ( )
+  {
+    for (int k = 0  ;  k < rings_num  ;  ++k)
+      for (int s = 0  ;  s < SPOKES_NUM  ;  ++s)
+      {
+        Q3 world ;
+
+        if (rings_world( &world, k, s ))
+          screen_project( &rings_screen[k][s], world ) ;
+      }
+  }
+
+
+  // Fuxel for ring k, spoke s. Returns false if the vertex falls outside the world box.
+  inline
+  static
+  bool
+  rings_fuxel
+  ( Fuxel    *f
+  , const int k
+  , const int s
+  )
+  {
+    f->dist2osc     = rings_step * (k+1) ;
+    f->visibility   = visibility_get( rings_visibility[k], 1, s ) ;
+    f->paletteIndex = palette_row_get( rings_palette[k], 1, s ) ;
+    f->screen     = rings_screen[k][s] ;
+
+    return rings_world( &f->world, k, s ) ;
+  }
+
+
+  // Clip the ring chord or spoke edge from inside vertex fIn towards outside vertex fOut to the world box walls.
+  void
+  rings_clip
+  ( Fuxel       *clipped
+  , const Fuxel  fIn
+  , const Fuxel  fOut
+  )
+  {
+    const Q dx = fOut.world.x - fIn.world.x ;
+    const Q dy = fOut.world.y - fIn.world.y ;
+    Q       k  = Q_1 ;
+    Q       kWall ;
+
+    if (fOut.world.x > world_xMax  &&  (kWall = Q_div( world_xMax - fIn.world.x, dx )) < k)
+      k = kWall ;
+    else if (fOut.world.x < world_xMin  &&  (kWall = Q_div( world_xMin - fIn.world.x, dx )) < k)
+      k = kWall ;
+
+    if (fOut.world.y > world_yMax  &&  (kWall = Q_div( world_yMax - fIn.world.y, dy )) < k)
+      k = kWall ;
+    else if (fOut.world.y < world_yMin  &&  (kWall = Q_div( world_yMin - fIn.world.y, dy )) < k)
+      k = kWall ;
+
+    *clipped = fIn ;
+    clipped->world.x += Q_mul( k, dx ) ;
+    clipped->world.y += Q_mul( k, dy ) ;
+
+    if (s_transparency != TRANSPARENCY_TRANSLUCENT)
+      clipped->visibility.fromCam = function_isVisible_fromPoint( clipped->world, s_cam.viewPoint, s_cam_viewPoint_boxing ) ;
+
+    screen_project( &clipped->screen, clipped->world ) ;
+  }
+
+
+  // Mesh edge between two vertices, clipped to the world box if only one of them is inside.
+  void
+  rings_drawEdge
+  ( GContext    *gCtx
+  , const Fuxel  f0
+  , const bool   in0
+  , const Fuxel  f1
+  , const bool   in1
+  )
+  {
+    if (in0  &&  in1)
+      function_draw_line( gCtx, f0, f1 ) ;
+    else if (in0 != in1)
     {
-      Fuxel f = (Fuxel){ .world      = (Q3){ .x = grid_major_x[i] << COORD_SHIFT
-                                           , .y = grid_major_y[j] << COORD_SHIFT
-                                           , .z = grid_major_z[i][j] << Z_SHIFT
-                                           }
-                       , .dist2osc   = grid_major_dist2osc[i][j] << DIST_SHIFT
-                       , .visibility = grid_major_visibility[i][j]
-                       , .screen     = grid_major_screen[i][j]
-                       }
-      ;
-
-      if (f.visibility.fromCam)
-        function_draw_pixel( gCtx, f ) ;
+      Fuxel clipped ;
+
+      if (in0)
+      {
+        rings_clip( &clipped, f0, f1 ) ;
+        function_draw_line( gCtx, f0, clipped ) ;
+      }
+      else
+      {
+        rings_clip( &clipped, f1, f0 ) ;
+        function_draw_line( gCtx, clipped, f1 ) ;
+      }
     }
-}
+  }
 
 
-void
-grid_minor_drawPixel
-( GContext *gCtx )
-{
-  for (int i = 0  ;  i < GRID_LINES-1  ;  i++)
-    for (int j = 0  ;  j < GRID_LINES-1 ;  j++)
+  void
+  rings_drawRing
+  ( GContext *gCtx
+  , int       k
+  )
+  {
+    Fuxel f0, f1 ;
+    bool  in0, in1 ;
+
+    in1 = rings_fuxel( &f1, k, 0 ) ;
+
+    for (int s = 1  ;  s <= SPOKES_NUM  ;  ++s)
     {
-      Fuxel f = (Fuxel){ .world      = (Q3){ .x = grid_minor_x[i] << COORD_SHIFT
-                                           , .y = grid_minor_y[j] << COORD_SHIFT
-                                           , .z = grid_minor_z[i][j] << Z_SHIFT
-                                           }
-                       , .dist2osc   = grid_minor_dist2osc[i][j] << DIST_SHIFT
-                       , .visibility = grid_minor_visibility[i][j]
-                       , .screen     = grid_minor_screen[i][j]
-                       }
-      ;
-
-      if (f.visibility.fromCam)
-        function_draw_pixel( gCtx, f ) ;
+      f0  = f1 ;
+      in0 = in1 ;
+      in1 = rings_fuxel( &f1, k, s % SPOKES_NUM ) ;
+
+      rings_drawEdge( gCtx, f0, in0, f1, in1 ) ;
     }
-}
 
+    polyline_rowEnd( gCtx ) ;
+  }
 
-void
-grid_major_drawPixel_XRAY
-( GContext *gCtx )
-{
-  for (int i = 0  ;  i < GRID_LINES  ;  ++i)
-    for (int j = 0  ;  j < GRID_LINES  ;  ++j)
+
+  // Spoke s from the innermost ring out. The oscillator is inside the world box, so is the spoke up to its first vertex
+  // outside: the box is convex.
+  void
+  rings_drawSpoke
+  ( GContext *gCtx
+  , int       s
+  )
+  {
+    Fuxel f0, f1 ;
+    bool  in1 = rings_fuxel( &f1, 0, s ) ;
+
+    for (int k = 1  ;  in1  &&  k < rings_num  ;  ++k)
     {
-      Fuxel f = (Fuxel){ .world      = (Q3){ .x = grid_major_x[i] << COORD_SHIFT
-                                           , .y = grid_major_y[j] << COORD_SHIFT
-                                           , .z = grid_major_z[i][j] << Z_SHIFT
-                                           }
-                       , .dist2osc   = grid_major_dist2osc[i][j] << DIST_SHIFT
-                       , .visibility = grid_major_visibility[i][j]
-                       , .screen     = grid_major_screen[i][j]
-                       }
-      ;
-
-      if (!f.visibility.fromCam)
-        function_draw_pixel( gCtx, f ) ;
+      f0  = f1 ;
+      in1 = rings_fuxel( &f1, k, s ) ;
+
+      rings_drawEdge( gCtx, f0, true, f1, in1 ) ;
     }
-}
 
+    polyline_rowEnd( gCtx ) ;
+  }
 
-void
-grid_minor_drawPixel_XRAY
-( GContext *gCtx )
-{
-  for (int i = 0  ;  i < GRID_LINES-1  ;  ++i)
-    for (int j = 0  ;  j < GRID_LINES-1  ;  ++j)
+
+  void
+  rings_drawRings
+  ( GContext *gCtx )
+  {
+    for (int k = 0  ;  k < rings_num  ;  ++k)
+      rings_drawRing( gCtx, k ) ;
+
+    for (int s = 0  ;  s < SPOKES_NUM  ;  ++s)
+      rings_drawSpoke( gCtx, s ) ;
+  }
+
+
+  void
+  rings_drawPixel_XRAY
+  ( GContext *gCtx )
+  {
+    for (int k = 0  ;  k < rings_num  ;  ++k)
+      for (uint32_t todo = ~rings_visibility[k][VISIBILITY_FROM_CAM] & ROW_MASK(SPOKES_NUM)  ;  todo != 0u  ;  todo &= todo - 1)
+      {
+        Fuxel f ;
+
+        if (rings_fuxel( &f, k, __builtin_ctz( todo ) ))
+          function_draw_pixel( gCtx, f ) ;
+      }
+  }
+#endif
+
+
+#ifdef PROFILE
+  // Draw stage timing each pattern. PATTERN_UNDEFINED draws nothing and is never timed.
+  static
+  ProfileStage
+  pattern_profileStage
+  ( const Pattern pattern )
+  {
+    switch (pattern)
     {
-      Fuxel f = (Fuxel){ .world      = (Q3){ .x = grid_minor_x[i] << COORD_SHIFT
-                                           , .y = grid_minor_y[j] << COORD_SHIFT
-                                           , .z = grid_minor_z[i][j] << Z_SHIFT
-                                           }
-                       , .dist2osc   = grid_minor_dist2osc[i][j] << DIST_SHIFT
-                       , .visibility = grid_minor_visibility[i][j]
-                       , .screen     = grid_minor_screen[i][j]
-                       }
-      ;
-
-      if (!f.visibility.fromCam)
-        function_draw_pixel( gCtx, f ) ;
+      case PATTERN_LINES:
+        return PROFILE_DRAW_LINES ;
+
+      case PATTERN_STRIPES:
+        return PROFILE_DRAW_STRIPES ;
+
+      case PATTERN_GRID:
+        return PROFILE_DRAW_GRID ;
+
+      case PATTERN_RINGS:
+        return PROFILE_DRAW_RINGS ;
+
+      case PATTERN_DOTS:
+      default:
+        return PROFILE_DRAW_DOTS ;
     }
-}
+  }
+#endif
 
 
 void
-function_draw_line
-( GContext    *gCtx
-, const Fuxel  f0
-, const Fuxel  f1
-)
+world_drawPattern
+( GContext *gCtx )
 {
-  if (!f0.visibility.fromCam && !f1.visibility.fromCam)    //  None of the points is visible ?
-    return ;
+  if (s_pattern == PATTERN_UNDEFINED)
+    return ;      // Nothing to draw, nor to time.
 
-  Fuxel  draw0, draw1 ;
+  PROFILE_SCOPE( pattern_profileStage( s_pattern ) ) ;
 
-  if (f0.visibility.fromCam && f1.visibility.fromCam)      //  Both points visible ?
+  // Draw the calculated screen points.
+  switch (s_pattern)
   {
-    draw0 = f0 ;
-    draw1 = f1 ;
+    case PATTERN_DOTS:
+      if (s_transparency == TRANSPARENCY_XRAY)
+        Lattice_drawPixel_XRAY( gCtx, s_lattice, LATTICE_FULL ) ;
+
+      Lattice_drawPixel( gCtx, s_lattice, LATTICE_FULL ) ;
+
+      // Grid frame.
+      Lattice_drawColumn( gCtx, s_lattice, 0                            ) ;
+      Lattice_drawColumn( gCtx, s_lattice, Lattice_size( s_lattice ) - 1 ) ;
+      Lattice_drawRow   ( gCtx, s_lattice, 0                            ) ;
+      Lattice_drawRow   ( gCtx, s_lattice, Lattice_size( s_lattice ) - 1 ) ;
+    break ;
+
+    case PATTERN_LINES:
+      if (s_transparency == TRANSPARENCY_XRAY)
+        Lattice_drawPixel_XRAY( gCtx, s_lattice, LATTICE_MAJOR ) ;
+
+      Lattice_drawColumns( gCtx, s_lattice, 0 ) ;
+
+      // Grid frame.
+      Lattice_drawRow( gCtx, s_lattice, 0                            ) ;
+      Lattice_drawRow( gCtx, s_lattice, Lattice_size( s_lattice ) - 1 ) ;
+    break ;
+
+    case PATTERN_STRIPES:
+      if (s_transparency == TRANSPARENCY_XRAY)
+        Lattice_drawPixel_XRAY( gCtx, s_lattice, LATTICE_FULL ) ;
+
+      Lattice_drawColumns( gCtx, s_lattice, 0 ) ;
+      Lattice_drawColumns( gCtx, s_lattice, 1 ) ;
+
+      // Grid frame.
+      Lattice_drawRow( gCtx, s_lattice, 0                            ) ;
+      Lattice_drawRow( gCtx, s_lattice, Lattice_size( s_lattice ) - 1 ) ;
+    break ;
+
+    case PATTERN_GRID:
+      if (s_transparency == TRANSPARENCY_XRAY)
+        Lattice_drawPixel_XRAY( gCtx, s_lattice, LATTICE_MAJOR ) ;
+
+      Lattice_drawColumns( gCtx, s_lattice, 0 ) ;
+      Lattice_drawRows( gCtx, s_lattice ) ;
+    break ;
+
+    case PATTERN_RINGS:
+#ifdef PBL_COLOR
+      if (s_transparency == TRANSPARENCY_XRAY)
+        rings_drawPixel_XRAY( gCtx ) ;
+
+      rings_drawRings( gCtx ) ;
+#endif
+    break ;
+
+    case PATTERN_UNDEFINED:
+    break ;
   }
-  else                                   //  Only one of the points is visible.
+
+#ifdef HEATMAP
+  if (s_heatmap_isOn  &&  s_pattern != PATTERN_RINGS)
+    Lattice_drawHeatmap( gCtx, s_lattice, pattern_latticeView( s_pattern ) ) ;
+#endif
+}
+
+
+#ifdef RASTER_CHECK
+  // Draws the frame through the SDK graphics calls, then again through the rasterizer, and logs how many pixels differ.
+  void
+  world_drawRasterCheck
+  ( Layer    *me
+  , GContext *gCtx
+  )
   {
-    Fuxel  terminator, invisible ;
+  #ifdef PBL_COLOR
+    graphics_context_set_antialiased( gCtx, false ) ;
+  #endif
 
-    if (f0.visibility.fromCam)
+    world_drawPattern( gCtx ) ;
+
+    GBitmap *frameBuffer = graphics_capture_frame_buffer( gCtx ) ;
+
+    if (frameBuffer == NULL)
+      return ;
+
+    const GRect    bounds      = gbitmap_get_bounds( frameBuffer ) ;
+    const bool     is1Bit      = (gbitmap_get_format( frameBuffer ) == GBitmapFormat1Bit) ;
+    const int      bytesPerRow = is1Bit ? (bounds.size.w + 7) >> 3 : bounds.size.w ;
+    uint8_t       *reference   = malloc( bounds.size.h * bytesPerRow ) ;
+
+    if (reference != NULL)
+      for (int y = 0  ;  y < bounds.size.h  ;  ++y)
+      {
+        const GBitmapDataRowInfo rowInfo = gbitmap_get_data_row_info( frameBuffer, y ) ;
+        const int                xMin    = is1Bit ? rowInfo.min_x >> 3 : rowInfo.min_x ;
+        const int                xMax    = is1Bit ? rowInfo.max_x >> 3 : rowInfo.max_x ;
+
+        memcpy( reference + y * bytesPerRow + xMin, rowInfo.data + xMin, xMax - xMin + 1 ) ;
+      }
+
+    graphics_release_frame_buffer( gCtx, frameBuffer ) ;
+
+    if (reference == NULL)
+      return ;
+
+    graphics_context_set_fill_color( gCtx, s_color_background ) ;
+    graphics_fill_rect( gCtx, layer_get_bounds( me ), 0, GCornerNone ) ;
+
+    if ((s_raster_isActive = Raster_begin( gCtx )))
     {
-      terminator = draw0 = f0 ;
-      invisible          = f1 ;
+      world_drawPattern( gCtx ) ;
+      s_raster_isActive = false ;
+
+      int diffs = 0 ;
+
+      // The SDK frame buffer was released above: read the rows through the rasterizer's capture, still held.
+      for (int y = 0  ;  y < bounds.size.h  ;  ++y)
+      {
+        const GBitmapDataRowInfo rowInfo = gbitmap_get_data_row_info( Raster_frameBuffer( ), y ) ;
+        const uint8_t           *ref     = reference + y * bytesPerRow ;
+
+        for (int x = rowInfo.min_x  ;  x <= rowInfo.max_x  ;  ++x)
+          if (is1Bit ? ((ref[x >> 3] ^ rowInfo.data[x >> 3]) >> (x & 7)) & 1 : ref[x] != rowInfo.data[x])
+            ++diffs ;
+      }
+
+      Raster_end( ) ;
+
+      APP_LOG( APP_LOG_LEVEL_INFO, "raster_check:: s_world_updateCount = %d, %d pixels differ", s_world_updateCount, diffs ) ;
     }
-    else
+
+    free( reference ) ;
+  }
+#endif
+
+
+#ifdef PRECISION
+/***  ---------------  Precision  ---------------  ***/
+
+//  Differential check of the fixed point kernels against a double precision reference, every PRECISION_FRAMES frames
+//  on every PRECISION_STRIDE-th vertex of the displayed lattice. Each reference starts from the engine's own inputs to
+//  that stage, so that the errors of a stage do not compound into the next ones:
+//    coord       the COORD_SHIFT packing of the evenly spaced line coordinates (no LOD only), world units.
+//    dist        Q_sqrt( ) and the DIST_SHIFT packing of the distances to the oscillator, world units.
+//    height      cos_lookup( ) and the Z_SHIFT packing of the heights, from the packed distances, world units.
+//    project     CamQ3_view( ) and the screen transform down to whole pixels, from the packed world points, pixels.
+//    visibility  the halving marcher against a PRECISION_MARCH_STEPS steps march of the double height field, mismatch
+//                rate over the cam visibility of the on screen vertices (opaque and x-ray only).
+
+  static PrecisionError  s_precision[PRECISION_STAGES] ;
+  static uint32_t        s_precision_testsNum ;
+  static uint32_t        s_precision_mismatchesNum ;
+  static int             s_precision_frame ;
+  static int             s_precision_filmSign[2] ;     // CamQ3_view( ) film axes against the cam's x and y axes.
+
+
+  inline
+  static
+  double
+  precision_double
+  ( const Q q )
+  { return q / (double)Q_1 ; }
+
+
+  void
+  precision_account
+  ( PrecisionError *error
+  , const double    value
+  , const double    reference
+  )
+  {
+    const double e = fabs( value - reference ) ;
+
+    if (e > error->max)
+      error->max = e ;
+
+    error->sum += e ;
+    ++error->num ;
+  }
+
+
+  // z = f( dist ) at the current oscillator phase.
+  double
+  precision_height
+  ( const double dist )
+  { return cos( M_PI * dist + 2.0 * M_PI * oscillator_anglePhase / TRIG_MAX_ANGLE ) ; }
+
+
+  double
+  precision_f_XY
+  ( const double x
+  , const double y
+  )
+  { return precision_height( hypot( precision_double( oscillator_position.x ) - x, precision_double( oscillator_position.y ) - y ) ) ; }
+
+
+  // Same pinhole model as CamQ3_view( ): cam axes coordinates of the view point to world vector, x and y over the depth.
+  void
+  precision_project
+  ( double       screen[2]
+  , const double world[3]
+  )
+  {
+    const Q3    *axes[3] = { &s_cam.xAxis, &s_cam.yAxis, &s_cam.zAxis } ;
+    const double d[3]    = { world[0] - precision_double( s_cam.viewPoint.x )
+                           , world[1] - precision_double( s_cam.viewPoint.y )
+                           , world[2] - precision_double( s_cam.viewPoint.z )
+                           } ;
+    double       cam[3] ;
+
+    for (int a = 0  ;  a < 3  ;  ++a)
+      cam[a] = d[0] * precision_double( axes[a]->x ) + d[1] * precision_double( axes[a]->y ) + d[2] * precision_double( axes[a]->z ) ;
+
+    const double zoom  = precision_double( s_cam_zoom ) ;
+    const double scale = precision_double( screen_project_scale ) ;
+
+    screen[0] = scale * s_precision_filmSign[0] * zoom * cam[0] / cam[2] + precision_double( screen_project_translate.x ) ;
+    screen[1] = scale * s_precision_filmSign[1] * zoom * cam[1] / cam[2] + precision_double( screen_project_translate.y ) ;
+  }
+
+
+  // Same criterion as function_isVisible_fromPoint( ), the view line clipped to the world box: hidden if the altitude
+  // over the height field changes sign along it.
+  bool
+  precision_isVisible
+  ( const double point[3]
+  , const Q3     viewPoint
+  )
+  {
+    const double viewer[3] = { precision_double( viewPoint.x ), precision_double( viewPoint.y ), precision_double( viewPoint.z ) } ;
+    const double lo[3]     = { precision_double( world_xMin ), precision_double( world_yMin ), precision_double( world_zMin ) } ;
+    const double hi[3]     = { precision_double( world_xMax ), precision_double( world_yMax ), precision_double( world_zMax ) } ;
+    double       d[3] ;
+    double       kMin = 1.0 ;
+
+    for (int a = 0  ;  a < 3  ;  ++a)
     {
-      terminator = draw0 = f1 ;
-      invisible          = f0 ;
+      d[a] = viewer[a] - point[a] ;
+
+      const double k = (viewer[a] > hi[a]) ? (hi[a] - point[a]) / d[a]
+                     : (viewer[a] < lo[a]) ? (lo[a] - point[a]) / d[a]
+                     : 1.0
+                     ;
+      if (k < kMin)
+        kMin = k ;
     }
 
-    for (int i = 0  ;  i < TERMINATOR_MAX_ITERATIONS  ;  ++i)    // TODO: replace with a while with screen point distance exit heuristic.
+    if (kMin < 1.0 / (2 << VISIBILITY_MAX_ITERATIONS))
+      return true ;
+
+    int sign = 0 ;
+
+    for (int i = 1  ;  i <= PRECISION_MARCH_STEPS  ;  ++i)
     {
-      Fuxel  half ;
+      const double k        = kMin * i / PRECISION_MARCH_STEPS ;
+      const double altitude = point[2] + k * d[2] - precision_f_XY( point[0] + k * d[0], point[1] + k * d[1] ) ;
+      const int    s        = (altitude > 0.0) - (altitude < 0.0) ;
 
-      half.world.x            = (terminator.world.x + invisible.world.x) >> 1 ;
-      half.world.y            = (terminator.world.y + invisible.world.y) >> 1 ;
-      half.dist2osc           = oscillator_distance( half.world.x, half.world.y ) ;
-      half.world.z            = f_distance( half.dist2osc ) ;
-      half.visibility.fromCam = function_isVisible_fromPoint( half.world, s_cam.viewPoint, s_cam_viewPoint_boxing ) ;
+      if (s == 0)
+        continue ;
 
-      if (half.visibility.fromCam)
-        terminator = half ;
-      else
-        invisible  = half ;
+      if (sign != 0  &&  s != sign)
+        return false ;
+
+      sign = s ;
     }
 
-    screen_project( &terminator.screen, terminator.world ) ;
-    draw1 = terminator ;
+    return true ;
   }
 
-#ifdef PBL_COLOR
-  set_stroke_color( gCtx, draw0 ) ;
 
-  graphics_draw_line( gCtx, draw0.screen, draw1.screen ) ;
-#else
-  Draw2D_line_pattern( gCtx
-                     , draw0.screen.x, draw0.screen.y
-                     , draw1.screen.x, draw1.screen.y
-                     , get_stroke_ink( draw0 )
-                     ) ;
-#endif
-}
+  void
+  precision_check
+  ( )
+  {
+    // The polar mesh has no lattice kept up to date.
+    if (s_lattice == NULL  ||  s_pattern == PATTERN_RINGS  ||  s_pattern == PATTERN_UNDEFINED)
+      return ;
 
+    const Lattice     *l    = s_lattice ;
+    const LatticeView  view = pattern_latticeView( s_pattern ) ;
 
-// x parallel line form function point (Fuxel) f0 to f1.
-void
-grid_major_drawLineX
-( GContext *gCtx
-, int       j
-)
-{
-  Fuxel f0, f1 ;
-  const Q grid_major_y_j = grid_major_y[j] << COORD_SHIFT ;
+  #ifndef LOD
+    for (int c = 0  ;  c < Lattice_size( l )  ;  ++c)
+      precision_account( &s_precision[PRECISION_COORD]
+                       , precision_double( l->xCoord[c] << COORD_SHIFT )
+                       , -GRID_SCALE / 2.0 + c * (double)GRID_SCALE / (Lattice_size( l ) - 1)
+                       ) ;
+  #endif
 
-  f1 = (Fuxel){ .world      = (Q3){ .x = grid_major_x[0] << COORD_SHIFT
-                                  , .y = grid_major_y_j
-                                  , .z = grid_major_z[0][j] << Z_SHIFT
-                                  }
-              , .dist2osc   = grid_major_dist2osc[0][j] << DIST_SHIFT
-              , .visibility = grid_major_visibility[0][j]
-              , .screen     = grid_major_screen[0][j]
-              }
-  ;
+    // Film axes directions, as CamQ3_view( ) sees a point ahead of the cam and off its x and y axes.
+    Q3 probe = s_cam.viewPoint ;  Q3_add( &probe, &probe, &s_cam.zAxis ) ;
+    probe.x += (s_cam.xAxis.x + s_cam.yAxis.x) >> 2 ;
+    probe.y += (s_cam.xAxis.y + s_cam.yAxis.y) >> 2 ;
+    probe.z += (s_cam.xAxis.z + s_cam.yAxis.z) >> 2 ;
 
-  for (int i = 1  ;  i < GRID_LINES-1 ;  ++i)
-  {
-    f0 = f1 ;
+    Q2 film ;  CamQ3_view( &film, &s_cam, &probe ) ;
 
-    f1 = (Fuxel){ .world      =  (Q3){ .x = grid_major_x[i] << COORD_SHIFT
-                                     , .y = grid_major_y_j
-                                     , .z = grid_major_z[i][j] << Z_SHIFT
-                                     }
-                , .dist2osc   = grid_major_dist2osc[i][j] << DIST_SHIFT
-                , .visibility = grid_major_visibility[i][j]
-                , .screen     = grid_major_screen[i][j]
-                }
-    ;
+    s_precision_filmSign[0] = (film.x < 0) ? -1 : +1 ;
+    s_precision_filmSign[1] = (film.y < 0) ? -1 : +1 ;
 
-    function_draw_line( gCtx, f0, f1 ) ;
-  }
-}
+    const bool isOccluding = (s_transparency == TRANSPARENCY_OPAQUE  ||  s_transparency == TRANSPARENCY_XRAY) ;
+    int        vertexNum   = 0 ;
 
+    for (int r = 0  ;  r < Lattice_size( l )  ;  r += Lattice_step( view ))
+      for (int k = 0  ;  k < Lattice_rowLength( l, r )  ;  ++k)
+      {
+        if (vertexNum++ % PRECISION_STRIDE != 0)
+          continue ;
 
-// y parallel line.
-void
-grid_major_drawLineY
-( GContext *gCtx
-, int       i
-)
-{
-  Fuxel f0, f1 ;
-  const Q grid_major_x_i = grid_major_x[i] << COORD_SHIFT ;
+        Fuxel f ;  Lattice_fuxel( &f, l, r, k ) ;
 
-  f1 = (Fuxel){ .world      = (Q3){ .x = grid_major_x_i
-                                  , .y = grid_major_y[0] << COORD_SHIFT
-                                  , .z = grid_major_z[i][0] << Z_SHIFT
-                                  }
-              , .visibility = grid_major_visibility[i][0]
-              , .dist2osc   = grid_major_dist2osc[i][0] << DIST_SHIFT
-              , .screen     = grid_major_screen[i][0]
-              }
-  ;
+        const double world[3] = { precision_double( f.world.x ), precision_double( f.world.y ), precision_double( f.world.z ) } ;
 
-  for (int j = 1  ;  j < GRID_LINES-1 ;  ++j)
-  {
-    f0 = f1 ;
+        precision_account( &s_precision[PRECISION_DIST]
+                         , precision_double( f.dist2osc )
+                         , hypot( precision_double( oscillator_position.x ) - world[0], precision_double( oscillator_position.y ) - world[1] )
+                         ) ;
 
-    f1 = (Fuxel){ .world      = (Q3){ .x = grid_major_x_i
-                                    , .y = grid_major_y[j] << COORD_SHIFT
-                                    , .z = grid_major_z[i][j] << Z_SHIFT
-                                    }
-                , .visibility = grid_major_visibility[i][j]
-                , .dist2osc   = grid_major_dist2osc[i][j] << DIST_SHIFT
-                , .screen     = grid_major_screen[i][j]
-                }
-    ;
+        precision_account( &s_precision[PRECISION_HEIGHT], world[2], precision_height( precision_double( f.dist2osc ) ) ) ;
 
-    function_draw_line( gCtx, f0, f1 ) ;
+        if (bits_get( Lattice_visibilityRow( l, r ) + VISIBILITY_CULLED * l->words, k ))
+          continue ;
+
+        double screen[2] ;  precision_project( screen, world ) ;
+
+        precision_account( &s_precision[PRECISION_PROJECT], 0.0, hypot( f.screen.x - screen[0], f.screen.y - screen[1] ) ) ;
+
+        if (isOccluding)
+        {
+          ++s_precision_testsNum ;
+
+          if (f.visibility.fromCam != precision_isVisible( world, s_cam.viewPoint ))
+            ++s_precision_mismatchesNum ;
+        }
+      }
   }
-}
 
 
-void
-grid_major_drawLinesX
-( GContext *gCtx )
-{
-  for (int l = 0  ;  l < GRID_LINES  ;  ++l)
-    grid_major_drawLineX( gCtx, l ) ;
-}
+  void
+  precision_report
+  ( )
+  {
+    static const char *stageNames[PRECISION_STAGES] = { "coord", "dist", "height", "project" } ;
+    static const char *stageUnits[PRECISION_STAGES] = { "1e-6 world units", "1e-6 world units", "1e-6 world units", "1e-3 pixels" } ;
+    static const int   stageScales[PRECISION_STAGES] = { 1000000, 1000000, 1000000, 1000 } ;
 
+    for (int stage = 0  ;  stage < PRECISION_STAGES  ;  ++stage)
+    {
+      const PrecisionError *error = &s_precision[stage] ;
+
+      if (error->num > 0)
+        APP_LOG( APP_LOG_LEVEL_INFO, "precision:: %s max %d mean %d %s over %u"
+               , stageNames[stage]
+               , (int)(error->max * stageScales[stage])
+               , (int)(error->sum / error->num * stageScales[stage])
+               , stageUnits[stage]
+               , (unsigned)error->num
+               ) ;
+    }
 
-void
-grid_major_drawLinesY
-( GContext *gCtx )
-{
-  for (int l = 0  ;  l < GRID_LINES  ;  ++l)
-    grid_major_drawLineY( gCtx, l ) ;
-}
+    if (s_precision_testsNum > 0)
+      APP_LOG( APP_LOG_LEVEL_INFO, "precision:: visibility %u mismatches over %u tests, %u per 10000"
+             , (unsigned)s_precision_mismatchesNum, (unsigned)s_precision_testsNum
+             , (unsigned)((uint64_t)s_precision_mismatchesNum * 10000 / s_precision_testsNum)
+             ) ;
+  }
 
 
-void
-grid_major_screen_project
-( )
-{
-  for (int i = 0  ;  i < GRID_LINES  ;  ++i)
+  // Once per complete frame.
+  void
+  precision_frame
+  ( )
   {
-    const Q grid_major_x_i = grid_major_x[i] << COORD_SHIFT ;
+    if (++s_precision_frame % PRECISION_FRAMES != 0)
+      return ;
+
+    precision_check( ) ;
 
-    for (int j = 0  ;  j < GRID_LINES  ;  ++j)
-      screen_project( &grid_major_screen[i][j]
-                    , (Q3){ .x = grid_major_x_i
-                          , .y = grid_major_y[j] << COORD_SHIFT
-                          , .z = grid_major_z[i][j] << Z_SHIFT
-                          }
-                    ) ;
+    if (s_precision_frame % (PRECISION_FRAMES * PRECISION_REPORT_CHECKS) == 0)
+      precision_report( ) ;
   }
-}
+#endif
 
 
-void
-grid_minor_drawLineX
-( GContext *gCtx
-, int       j
+#ifdef TELEMETRY
+  // Frame record of the frame just drawn, ahead of the per frame stats reports that clear the counters.
+  void
+  telemetry_frame
+  ( )
+  {
+    uint32_t ticks [PROFILE_STAGES] ;
+    uint32_t fields[TELEMETRY_FIELDS] ;
+
+    Profile_frame_take( ticks ) ;
+
+    fields[TELEMETRY_STEPS           ] = s_frame_steps ;
+    fields[TELEMETRY_OSCILLATOR      ] = ticks[PROFILE_OSCILLATOR] ;
+    fields[TELEMETRY_GRID_Z          ] = ticks[PROFILE_GRID_Z    ] ;
+    fields[TELEMETRY_CAMERA          ] = ticks[PROFILE_CAMERA    ] ;
+    fields[TELEMETRY_PROJECT         ] = ticks[PROFILE_PROJECT   ] ;
+    fields[TELEMETRY_VISIBILITY      ] = ticks[PROFILE_VISIBILITY] ;
+    fields[TELEMETRY_DRAW            ] = 0 ;
+    fields[TELEMETRY_F_XY            ] = s_work_fXYNum ;
+    fields[TELEMETRY_Q_DIV           ] = s_work_divNum ;
+    fields[TELEMETRY_Q_SQRT          ] = s_work_sqrtNum ;
+    fields[TELEMETRY_TESTS           ] = s_work_testsNum ;
+    fields[TELEMETRY_PROBES          ] = s_work_probesNum ;
+    fields[TELEMETRY_TERMINATOR_STEPS] = s_work_terminatorStepsNum ;
+    fields[TELEMETRY_SEGMENTS        ] = s_work_segmentsNum ;
+
+    for (int stage = PROFILE_DRAW_DOTS  ;  stage <= PROFILE_DRAW_RINGS  ;  ++stage)
+      fields[TELEMETRY_DRAW] += ticks[stage] ;
+
+    Telemetry_frame( fields ) ;
+  }
+#endif
+
+
+// Copies the drawable rows of the frame buffer to the snapshot, or back. A NULL snapshot only counts their bytes.
+size_t
+frame_snapshot_rows
+( GBitmap    *frameBuffer
+, uint8_t    *snapshot
+, const bool  isSave
 )
 {
-  Fuxel f0, f1 ;
-  const Q grid_minor_y_j = grid_minor_y[j] << COORD_SHIFT ;
-
-  f1 = (Fuxel){ .world      = (Q3){ .x = grid_minor_x[0] << COORD_SHIFT
-                                  , .y = grid_minor_y_j
-                                  , .z = grid_minor_z[0][j] << Z_SHIFT
-                                  }
-              , .dist2osc   = grid_minor_dist2osc[0][j] << DIST_SHIFT
-              , .visibility = grid_minor_visibility[0][j]
-              , .screen     = grid_minor_screen[0][j]
-              }
-  ;
+  const GRect bounds = gbitmap_get_bounds( frameBuffer ) ;
+  const bool  is1Bit = (gbitmap_get_format( frameBuffer ) == GBitmapFormat1Bit) ;
+  size_t      bytes  = 0 ;
 
-  for (int i = 1  ;  i < GRID_LINES-2 ;  ++i)
+  for (int y = 0  ;  y < bounds.size.h  ;  ++y)
   {
-    f0 = f1 ;
-    
-    f1 = (Fuxel){ .world      = (Q3){ .x = grid_minor_x[i] << COORD_SHIFT
-                                    , .y = grid_minor_y_j
-                                    , .z = grid_minor_z[i][j] << Z_SHIFT
-                                    }
-                , .dist2osc   = grid_minor_dist2osc[i][j] << DIST_SHIFT
-                , .visibility = grid_minor_visibility[i][j]
-                , .screen     = grid_minor_screen[i][j]
-                }
-    ;
+    const GBitmapDataRowInfo rowInfo = gbitmap_get_data_row_info( frameBuffer, y ) ;
+    const int                xMin    = is1Bit ? rowInfo.min_x >> 3 : rowInfo.min_x ;
+    const int                xMax    = is1Bit ? rowInfo.max_x >> 3 : rowInfo.max_x ;
 
-    function_draw_line( gCtx, f0, f1 ) ;
+    if (snapshot != NULL  &&  isSave)
+      memcpy( snapshot + bytes, rowInfo.data + xMin, xMax - xMin + 1 ) ;
+    else if (snapshot != NULL)
+      memcpy( rowInfo.data + xMin, snapshot + bytes, xMax - xMin + 1 ) ;
+
+    bytes += xMax - xMin + 1 ;
   }
+
+  return bytes ;
 }
 
 
+// Keeps the complete frame just drawn, for the world_draw( ) calls until the next one. Only if the heap can spare it on
+// top of GRID_MEMORY_RESERVE: without it they finish the frame under way instead.
 void
-grid_minor_drawLinesX
+frame_snapshot_save
 ( GContext *gCtx )
 {
-  for (int l = 0  ;  l < GRID_LINES-1  ;  ++l)
-    grid_minor_drawLineX( gCtx, l ) ;
+  GBitmap *frameBuffer = graphics_capture_frame_buffer( gCtx ) ;
+
+  if (frameBuffer == NULL)
+    return ;
+
+  if (s_frame_snapshotBytes == 0)
+    s_frame_snapshotBytes = frame_snapshot_rows( frameBuffer, NULL, true ) ;
+
+  if (s_frame_snapshot == NULL  &&  heap_bytes_free( ) >= s_frame_snapshotBytes + GRID_MEMORY_RESERVE)
+  {
+    s_frame_snapshot = malloc( s_frame_snapshotBytes ) ;
+    MEMORY_MARK( "frame_snapshot_save( )" ) ;
+  }
+
+  if (s_frame_snapshot != NULL)
+    frame_snapshot_rows( frameBuffer, s_frame_snapshot, true ) ;
+
+  graphics_release_frame_buffer( gCtx, frameBuffer ) ;
 }
 
 
-void
-grid_minor_screen_project
-( )
+// Draws the last complete frame again. Returns false without a snapshot of it.
+bool
+frame_snapshot_restore
+( GContext *gCtx )
 {
-  for (int i = 0  ;  i < GRID_LINES-1  ;  ++i)
-  {
-    const Q grid_minor_x_i = grid_minor_x[i] << COORD_SHIFT ;
+  GBitmap *frameBuffer ;
 
-    for (int j = 0  ;  j < GRID_LINES-1  ;  ++j)
-      screen_project( &grid_minor_screen[i][j]
-                    , (Q3){ .x = grid_minor_x_i
-                          , .y = grid_minor_y[j] << COORD_SHIFT
-                          , .z = grid_minor_z[i][j] << Z_SHIFT
-                          }
-                    ) ;
-  }
+  if (s_frame_snapshot == NULL  ||  (frameBuffer = graphics_capture_frame_buffer( gCtx )) == NULL)
+    return false ;
+
+  frame_snapshot_rows( frameBuffer, s_frame_snapshot, false ) ;
+  graphics_release_frame_buffer( gCtx, frameBuffer ) ;
+
+  return true ;
 }
 
 
 void
-grid_screen_project
+frame_snapshot_free
 ( )
 {
-  switch (s_pattern)
-  {
-    case PATTERN_DOTS:
-    case PATTERN_STRIPES:
-      grid_minor_screen_project( ) ;
-
-    case PATTERN_LINES:
-    case PATTERN_GRID:
-      grid_major_screen_project( ) ;
-    break ;
-
-    case PATTERN_UNDEFINED:
-    break ;
-  }
+  free( s_frame_snapshot ) ;
+  s_frame_snapshot = NULL ;
 }
 
 
+// Draws the complete frame, the frame under way finished first if need be.
 void
-world_draw
+world_drawFrame
 ( Layer    *me
 , GContext *gCtx
 )
@@ -1657,65 +4739,78 @@ world_draw
   graphics_context_set_stroke_color( gCtx, s_color_stroke ) ;
 #endif
 
-  grid_screen_project( ) ;
+  world_update_finish( ) ;
 
-  // Draw the calculated screen points.
-  switch (s_pattern)
-  {
-    case PATTERN_DOTS:
-      if (s_transparency == TRANSPARENCY_XRAY)
-      {
-        grid_major_drawPixel_XRAY( gCtx ) ;
-        grid_minor_drawPixel_XRAY( gCtx ) ;
-      }
+  const uint32_t start = Clock_ms( ) ;
 
-      grid_major_drawPixel( gCtx ) ;
-      grid_minor_drawPixel( gCtx ) ;
+  // Lattice or cam changed since the last complete frame.
+  if (!s_grid_isProjected)
+    grid_screen_project( false ) ;
 
-      // Grid frame.
-      grid_major_drawLineX( gCtx, 0            ) ;
-      grid_major_drawLineX( gCtx, GRID_LINES-1 ) ;
-      grid_major_drawLineY( gCtx, 0            ) ;
-      grid_major_drawLineY( gCtx, GRID_LINES-1 ) ;
-    break ;
+#if defined(RASTER_CHECK)
+  world_drawRasterCheck( me, gCtx ) ;
+#elif defined(RASTER)
+  // The rasterizer does not antialias, leave those frames to the SDK.
+  s_raster_isActive = PBL_IF_COLOR_ELSE(!s_antialiasing, true)  &&  Raster_begin( gCtx ) ;
 
-    case PATTERN_LINES:
-      if (s_transparency == TRANSPARENCY_XRAY)
-        grid_major_drawPixel_XRAY( gCtx ) ;
+  world_drawPattern( gCtx ) ;
 
-      grid_major_drawLinesX( gCtx ) ;
+  if (s_raster_isActive)
+  {
+    Raster_end( ) ;
+    s_raster_isActive = false ;
+  }
+#else
+  world_drawPattern( gCtx ) ;
+#endif
 
-      // Grid frame.
-      grid_major_drawLineY( gCtx, 0            ) ;
-      grid_major_drawLineY( gCtx, GRID_LINES-1 ) ;
-    break ;
+#ifdef TELEMETRY
+  telemetry_frame( ) ;
+#endif
 
-    case PATTERN_STRIPES:
-      if (s_transparency == TRANSPARENCY_XRAY)
-      {
-        grid_major_drawPixel_XRAY( gCtx ) ;
-        grid_minor_drawPixel_XRAY( gCtx ) ;
-      }
+#ifdef BENCH
+  bench_frame( ) ;
+#endif
 
-      grid_major_drawLinesX( gCtx ) ;
-      grid_minor_drawLinesX( gCtx ) ;
+#ifdef GOLDEN
+  golden_dump( gCtx ) ;
+#endif
 
-      // Grid frame.
-      grid_major_drawLineY( gCtx, 0            ) ;
-      grid_major_drawLineY( gCtx, GRID_LINES-1 ) ;
-    break ;
+  polyline_stats_report( ) ;
+  cull_stats_report( ) ;
+  work_stats_report( ) ;
 
-    case PATTERN_GRID:
-      if (s_transparency == TRANSPARENCY_XRAY)
-        grid_major_drawPixel_XRAY( gCtx ) ;
+  frame_snapshot_save( gCtx ) ;
 
-      grid_major_drawLinesX( gCtx ) ;
-      grid_major_drawLinesY( gCtx ) ;
-    break ;
+  activity_cpu( Clock_ms( ) - start ) ;
+}
 
-    case PATTERN_UNDEFINED:
-    break ;
+
+void
+world_draw
+( Layer    *me
+, GContext *gCtx
+)
+{
+  // A mode changed, or the frame under way is halfway through its chunks: the last complete frame again rather than
+  // wait for this one.
+  const uint32_t start   = Clock_ms( ) ;
+  const bool     isFrame = s_frame_isDrawable  ||  !frame_snapshot_restore( gCtx ) ;
+
+  if (isFrame)
+    world_drawFrame( me, gCtx ) ;
+  else
+    activity_cpu( Clock_ms( ) - start ) ;
+
+  // Only once drawn: the next frame's chunks overwrite the lattice.
+  if (s_frame_isDrawDue)
+  {
+    s_frame_isDrawDue = false ;
+    world_update_schedule( ) ;
   }
+
+  if (isFrame)
+    frame_stats_drawn( ) ;
 }
 
 
@@ -1723,9 +4818,8 @@ void
 world_finalize
 ( )
 {
-#ifndef GIF
-  accelSamplers_finalize( ) ;
-#endif
+  s_lattice = Lattice_destroy( s_lattice ) ;
+  frame_snapshot_free( ) ;
 }
 
 
@@ -1734,25 +4828,91 @@ world_update_timer_handler
 ( void *data )
 {
   s_world_updateTimer_ptr = NULL ;
-  world_update( ) ;
+  s_frame_isInChunk       = true ;
 
-#ifdef GIF
-  if (s_world_updateCount < GIF_STOP_COUNT)
+  const uint32_t start      = Clock_ms( ) ;
+  const bool     isComplete = world_update_chunk( ) ;
+
+  s_frame_isInChunk = false ;
+  frame_stats_chunk( Clock_ms( ) - start ) ;
+
+  if (!isComplete)
+  {
+    // Next chunk as soon as the pending events are handled.
+    s_world_updateTimer_ptr = app_timer_register( 0, world_update_timer_handler, data ) ;
+    return ;
+  }
+
+  frame_complete( ) ;
+
+#ifdef PRECISION
+  precision_frame( ) ;
 #endif
-  s_world_updateTimer_ptr = app_timer_register( ANIMATION_INTERVAL_MS, world_update_timer_handler, data ) ;
+
+  // this will queue a defered call to the world_draw( ) method, that arms the next frame once this one is drawn.
+  s_frame_isDrawDue = true ;
+  layer_mark_dirty( s_world_layer ) ;
 }
 
 
+#ifdef CAMERA_MEASURE
+  #define CAMERA_MEASURE_CALLS   256
+
+  // Per frame cam cost: camera_update( ) timed over enough calls to rise above the ms clock resolution. Watch only: the
+  // tools/host clock is simulated and stands still here, logging 0 us. The cam is put back as it was: the first frames
+  // (their LOD) must not depend on CAMERA_MEASURE.
+  void
+  camera_measure
+  ( )
+  {
+    const CamQ3    cam                 = s_cam ;
+    const Q3       cam_viewPoint       = s_cam_viewPoint ;
+    const Boxing   cam_viewPointBoxing = s_cam_viewPoint_boxing ;
+    const uint32_t start               = Clock_ms( ) ;
+
+    for (int i = 0  ;  i < CAMERA_MEASURE_CALLS  ;  ++i)
+      camera_update( ) ;
+
+    LOGD( "camera_measure:: %d us per camera_update( )", (int)((Clock_ms( ) - start) * 1000 / CAMERA_MEASURE_CALLS) ) ;
+
+    s_cam                  = cam ;
+    s_cam_viewPoint        = cam_viewPoint ;
+    s_cam_viewPoint_boxing = cam_viewPointBoxing ;
+  }
+#endif
+
+
 void
 world_start
 ( )
 {
 #ifndef GIF
   // Gravity aware.
- 	accel_data_service_subscribe( 0, accel_data_service_handler ) ;
+  Accel_start( ACCEL_SAMPLING_RATE, ACCEL_BATCH_SAMPLES ) ;
+
+  // Attention aware.
+  accel_tap_service_subscribe( accel_tap_handler ) ;
+  app_focus_service_subscribe_handlers( (AppFocusHandlers){ .will_focus = app_focus_handler } ) ;
+#endif
+
+#ifdef CAMERA_MEASURE
+  camera_measure( ) ;
+#endif
+
+#ifdef PROFILE
+  Profile_initialize( ) ;
+#endif
+
+#if defined(TRACE_RECORD)
+  Trace_record_start( ) ;
+#elif defined(TRACE_REPLAY)
+  Trace_load( ) ;
 #endif
 
   // Start animation.
+  s_activity_modeSinceMs = Clock_ms( ) ;
+  activity_wake( ) ;
+  sim_clock_reset( ) ;
   world_update_timer_handler( NULL ) ;
 }
 
@@ -1770,11 +4930,90 @@ world_stop
 
 #ifndef GIF
   // Gravity unaware.
-  accel_data_service_unsubscribe( ) ;
+  Accel_stop( ) ;
+
+  // Attention unaware.
+  accel_tap_service_unsubscribe( ) ;
+  app_focus_service_unsubscribe( ) ;
+#endif
+
+  activity_report( ) ;
+
+#ifdef PROFILE
+  Profile_report( ) ;
+#endif
+
+#ifdef TRACE_RECORD
+  Trace_save( ) ;
+#endif
+
+#ifdef PRECISION
+  precision_report( ) ;
 #endif
 }
 
 
+#ifdef PROFILE
+  // SELECT long click delay (the SDK default), and the total hold from which its release logs the percentiles instead
+  // of changing the transparency.
+  #define PROFILE_LONG_CLICK_MS     500
+  #define PROFILE_REPORT_HOLD_MS   1500
+
+  static uint32_t s_profile_longClickMs ;
+
+
+  // SELECT long click reached: the transparency waits for the release, the hold decides.
+  void
+  profile_longClick_down_handler
+  ( ClickRecognizerRef recognizer
+  , void              *context
+  )
+  { s_profile_longClickMs = Clock_ms( ) ; }
+
+
+  void
+  profile_longClick_up_handler
+  ( ClickRecognizerRef recognizer
+  , void              *context
+  )
+  {
+    if (Clock_ms( ) - s_profile_longClickMs + PROFILE_LONG_CLICK_MS < PROFILE_REPORT_HOLD_MS)
+      transparency_change_click_handler( recognizer, context ) ;
+    else
+      Profile_report( ) ;
+  }
+#endif
+
+
+#ifdef TRACE_REPLAY
+  // Recorded clicks back to their handlers.
+  void
+  trace_click_dispatch
+  ( const uint8_t click )
+  {
+  #ifdef BENCH
+    return ;    // The bench sets the modes of its scenarios.
+  #endif
+
+    static const ClickHandler handlers[TRACE_CLICKS] =
+    { [TRACE_CLICK_COLORIZATION   ] = (ClickHandler) colorization_change_click_handler
+    , [TRACE_CLICK_PATTERN        ] = (ClickHandler) pattern_change_click_handler
+    , [TRACE_CLICK_OSCILLATOR     ] = (ClickHandler) oscillatorMode_change_click_handler
+    , [TRACE_CLICK_GRID_RESOLUTION] = (ClickHandler) grid_resolution_change_click_handler
+    , [TRACE_CLICK_TRANSPARENCY   ] = (ClickHandler) transparency_change_click_handler
+  #ifdef PBL_COLOR
+    , [TRACE_CLICK_ANTIALIASING   ] = (ClickHandler) antialiasing_change_click_handler
+  #else
+    , [TRACE_CLICK_INVERT         ] = (ClickHandler) invert_change_click_handler
+  #endif
+    } ;
+
+    if (click < TRACE_CLICKS  &&  handlers[click] != NULL)
+      handlers[click]( NULL, NULL ) ;
+  }
+#endif
+
+
 void
 click_config_provider
 ( void *context )
@@ -1799,11 +5038,26 @@ click_config_provider
 #endif
 
   // Long click.
+  window_long_click_subscribe( BUTTON_ID_UP
+                             , 0
+                             , (ClickHandler) grid_resolution_change_click_handler
+                             , NULL
+                             ) ;
+
+#ifdef PROFILE
+  // Held past PROFILE_REPORT_HOLD_MS the long click logs the percentiles: the single clicks are not delayed.
+  window_long_click_subscribe( BUTTON_ID_SELECT
+                             , PROFILE_LONG_CLICK_MS
+                             , (ClickHandler) profile_longClick_down_handler
+                             , (ClickHandler) profile_longClick_up_handler
+                             ) ;
+#else
   window_long_click_subscribe( BUTTON_ID_SELECT
                              , 0
                              , (ClickHandler) transparency_change_click_handler
                              , NULL
                              ) ;
+#endif
 
 #ifdef PBL_COLOR
   window_long_click_subscribe( BUTTON_ID_DOWN
@@ -1837,10 +5091,26 @@ window_load
 
   screen_project_translate.x = Q_from_int(screen_availableSize.w) >> 1 ;
   screen_project_translate.y = Q_from_int(screen_availableSize.h) >> 1 ;
+  screen_center              = GPoint( screen_availableSize.w >> 1, screen_availableSize.h >> 1 ) ;
+
+  // The world layer is drawn over the whole window, action bar included (same background color): the action bar area is
+  // visible, culling it would clip the lattice there.
+  const GSize screen_size = layer_get_frame( s_window_layer ).size ;
+
+  screen_cullMin = GPoint( -SCREEN_CULL_MARGIN, -SCREEN_CULL_MARGIN ) ;
+  screen_cullMax = GPoint( screen_size.w - 1 + SCREEN_CULL_MARGIN, screen_size.h - 1 + SCREEN_CULL_MARGIN ) ;
+
+#ifdef PBL_ROUND
+  // Octagon sides tangent to the display circle: sqrt(2) ~ 181/128.
+  screen_cullDiagonal = ((screen_size.w >> 1) + SCREEN_CULL_MARGIN) * 181 / 128 + 1 ;
+#endif
 
   s_action_bar_layer = action_bar_layer_create( ) ;
   action_bar_layer_set_background_color     ( s_action_bar_layer, s_color_background    ) ;
+#ifndef TRACE_REPLAY
+  // Replays take their clicks from the trace.
   action_bar_layer_set_click_config_provider( s_action_bar_layer, click_config_provider ) ;
+#endif
 
   s_world_layer = layer_create( layer_get_frame( s_window_layer ) ) ;
   layer_set_update_proc( s_world_layer, world_draw ) ;
@@ -1849,6 +5119,8 @@ window_load
   action_bar_layer_add_to_window( s_action_bar_layer, s_window ) ;
   layer_add_child( s_window_layer, s_world_layer ) ;
 
+  MEMORY_MARK( "layers" ) ;
+
   world_start( ) ;
 }
 
@@ -1864,13 +5136,49 @@ window_unload
 }
 
 
+#ifdef MEMORY
+  // Static arrays by group, those of the other modules are sized in main.h.
+  void
+  memory_statics_report
+  ( )
+  {
+    APP_LOG( APP_LOG_LEVEL_INFO, "memory:: %s statics dy2 %u, lod %u, cull %u, polyline %u, rings %u, accel %u bytes"
+           , MEMORY_PLATFORM
+           , (unsigned)sizeof(dy2)
+    #ifdef LOD
+           , (unsigned)(sizeof(lod_mass) + sizeof(lod_crest) + sizeof(lod_target))
+    #else
+           , 0u
+    #endif
+           , (unsigned)sizeof(cull_outcodes)
+           , (unsigned)sizeof(s_polyline_points)
+    #ifdef PBL_COLOR
+           , (unsigned)(sizeof(spokes_cos) + sizeof(spokes_sin) + sizeof(rings_z) + sizeof(rings_visibility) + sizeof(rings_screen) + sizeof(rings_palette))
+    #else
+           , 0u
+    #endif
+           , (unsigned)(ACCEL_RING_CAPACITY * sizeof(AccelSample))
+           ) ;
+  }
+#endif
+
+
 void
 app_initialize
 ( void )
 {
+#ifdef MEMORY
+  memory_statics_report( ) ;
+#endif
+
   world_initialize( ) ;
 
+#ifdef TELEMETRY
+  Telemetry_start( ) ;
+#endif
+
   s_window = window_create( ) ;
+  MEMORY_MARK( "window_create( )" ) ;
   window_set_background_color( s_window, s_color_background ) ;
 
   window_set_window_handlers( s_window
@@ -1891,6 +5199,10 @@ app_finalize
   window_stack_remove( s_window, false ) ;
   window_destroy( s_window ) ;
   world_finalize( ) ;
+
+#ifdef MEMORY
+  Memory_stack_report( ) ;
+#endif
 }
 
 
@@ -1898,6 +5210,10 @@ int
 main
 ( void )
 {
+#ifdef MEMORY
+  Memory_stack_paint( ) ;
+#endif
+
   app_initialize( ) ;
   app_event_loop( ) ;
   app_finalize( ) ;
@@ -40,8 +40,72 @@
 #endif
 
 
-// Animation related: adds wrist movement reaction inertia to dampen accelerometer jerkiness.
-#define ACCEL_SAMPLER_CAPACITY    8
+// Simulation step: the wall clock span of one oscillator/cam tick, whatever the render interval. Catch up steps for
+// frames that fell behind are capped at SIM_STEPS_MAX, beyond that the ripples slow down rather than jump.
+#define SIM_STEP_MS               50
+#define SIM_STEPS_MAX             4
+
+// Activity: consecutive still frames before each halving of the frame rate, and how many halvings at most. Still means
+// accelerometer readings within ACTIVITY_ACCEL_THRESHOLD (mG, summed over the axes) of those at the last wake up and,
+// for OSCILLATOR_BOUNCING, an oscillator speed below ACTIVITY_SPEED_EPSILON.
+#define ACTIVITY_IDLE_FRAMES      40
+#define ACTIVITY_IDLE_LEVEL_MAX   3
+#define ACTIVITY_ACCEL_THRESHOLD  120
+#define ACTIVITY_SPEED_EPSILON    (Q_1 >> 10)
+
+// Keyframes: simulation steps between full frames, the lattice heights of the frames in between are interpolated.
+#define KEYFRAME_TICKS            2
+
+// Accelerometer feed: sampled at 25Hz, in batches of at most one frame interval worth of samples so that every frame
+// finds a fresh one (one sample every 40ms for 50ms frames). The oscillator reads an exponential moving average of weight
+// 1/2^ACCEL_EMA_LEVEL (ACCEL_EMA_SHIFT fraction bits), the cam the mean of a ring buffer of the raw samples, whose length
+// adds wrist movement reaction inertia (~400ms). Each reader gets one low-pass filter, not both.
+#define ACCEL_SAMPLING_RATE       ACCEL_SAMPLING_25HZ
+#define ACCEL_SAMPLING_HZ         25
+#define ACCEL_BATCH_SAMPLES       ((ANIMATION_INTERVAL_MS * ACCEL_SAMPLING_HZ >= 1000) ? ANIMATION_INTERVAL_MS * ACCEL_SAMPLING_HZ / 1000 : 1)
+#define ACCEL_EMA_LEVEL           1
+#define ACCEL_EMA_SHIFT           8
+#define ACCEL_RING_CAPACITY       10
+
+// Profile: latest stage timings kept for exact percentiles, on top of the whole run log2 histograms.
+#define PROFILE_RING_CAPACITY     64
+
+// Memory: stack bytes painted below main( ), within the 2KB app stack of the smallest platforms.
+#define MEMORY_STACK_PAINT_BYTES  1536
+
+// Telemetry: one batch of up to TELEMETRY_BATCH_FRAMES frame records per TELEMETRY_INTERVAL_MS at most.
+#define TELEMETRY_INTERVAL_MS     1000
+#define TELEMETRY_BATCH_FRAMES    32
+
+// Trace: bytes recorded at most (about 15 s of 25Hz accelerometer samples), stored from persistent key TRACE_PERSIST_KEY on.
+#define TRACE_BYTES_MAX           3584
+#define TRACE_PERSIST_KEY         0x7400
+
+// Bench: frames run per scenario, its first BENCH_WARMUP_FRAMES left out of the sums (pattern switch transients), at a
+// resolution pinned whatever the heap would afford, so that runs on different builds compare.
+#define BENCH_WARMUP_FRAMES       4
+#define BENCH_FRAMES              32
+#define BENCH_GRID_LINES          PBL_IF_COLOR_ELSE(27, 25)
+
+// Precision: a check every PRECISION_FRAMES frames on every PRECISION_STRIDE-th vertex, logged every
+// PRECISION_REPORT_CHECKS checks. The reference visibility marches the view line in PRECISION_MARCH_STEPS steps.
+#define PRECISION_FRAMES          16
+#define PRECISION_STRIDE          3
+#define PRECISION_REPORT_CHECKS   8
+#define PRECISION_MARCH_STEPS     256
+
+// Golden frames: the update counts of each scenario whose frames are logged, the last one ends the scenario.
+#define GOLDEN_COUNTS             { 1, 24, 72 }
+
+// Frame computation chunks: rows of occlusion tests per timer callback (a few times more for the cheaper z), short
+// enough to keep button clicks responsive on the slower APLITE CPU.
+#ifdef PBL_PLATFORM_APLITE
+  #define FRAME_CHUNK_ROWS        4
+#else
+  #define FRAME_CHUNK_ROWS        8
+#endif
+
+#define FRAME_Z_CHUNK_FACTOR      4
 
 #define VISIBILITY_MAX_ITERATIONS   4
 #define TERMINATOR_MAX_ITERATIONS   3
@@ -49,17 +113,56 @@
 
 /* -----------   GRID/CAMERA PARAMETERS   ----------- */
 
+// Grid resolution is chosen at run time (long UP click cycles it) from GRID_LINES_MIN up to what the free heap affords,
+// capped by GRID_LINES_MAX according to the platform CPU class: vertex count, and so frame cost, grows with lines^2.
 #ifdef PBL_COLOR
-  #define  GRID_LINES     27
+  #define  GRID_LINES_DEFAULT   27
+  #define  GRID_LINES_MAX       43
 #else
-  // Any more lines and APLITE will crash.
-  #define  GRID_LINES     25
+  // Low RAM grid storage profile: 8 bit screen offsets. With the minor grid on the heap it lets APLITE go past 25 lines,
+  // see grid_memory_report( ) for the per array accounting.
+  #define  GRID_COMPACT
+  #define  GRID_LINES_DEFAULT   29
+
+  #ifdef PBL_PLATFORM_APLITE
+    #define  GRID_LINES_MAX     33
+  #else
+    #define  GRID_LINES_MAX     37
+  #endif
+#endif
+
+#define  GRID_LINES_MIN       11
+#define  GRID_LINES_STEP      4
+
+// The long UP click cycle goes GRID_LINES_STEP apart from its first value on, through GRID_LINES_DEFAULT.
+#define  GRID_LINES_FIRST     (GRID_LINES_MIN + (GRID_LINES_DEFAULT - GRID_LINES_MIN) % GRID_LINES_STEP)
+
+#ifdef LOD
+  // Level of detail: how each axis' grid lines are shared between even spacing, projected cell size (denser near the
+  // cam, sparser far away) and height variation across cells (denser on steep crests). Shares must add up to 1.
+  #define  LOD_SHARE_UNIFORM    0.25f
+  #define  LOD_SHARE_CAM        0.5f
+  #define  LOD_SHARE_CREST      0.25f
+
+  // Lines move 1/2^LOD_SMOOTHING_LEVEL of the way to their target spacing per frame, once it is further than
+  // 1/2^LOD_DEADBAND_LEVEL of an even cell.
+  #define  LOD_SMOOTHING_LEVEL  2
+  #define  LOD_DEADBAND_LEVEL   3
+#endif
+
+#ifdef PBL_COLOR
+  // Polar mesh centered on the oscillator: enough rings to reach the far corner of the grid from any oscillator position.
+  #define  RINGS_NUM      40
+  #define  SPOKES_NUM     32
 #endif
 
 // The GRID_SCALE value bellow has been precison engineered as to saturate x,y grid coord tables in signed Q3.12 format (int16_t),
 // make 100% SURE you do the proper (required) adjustments if you ever change this value.
 #define  GRID_SCALE                 7.9999f
 
+// Vertices and segments this many pixels off screen are culled, the margin keeps antialiased strokes whole.
+#define  SCREEN_CULL_MARGIN         2
+
 #define  CAM3D_DISTANCEFROMORIGIN   9.75f
 #define  LIGHT_DISTANCEFROMORIGIN   9.75f
 
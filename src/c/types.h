@@ -27,6 +27,7 @@ typedef enum { PATTERN_UNDEFINED
              , PATTERN_LINES
              , PATTERN_STRIPES
              , PATTERN_GRID
+             , PATTERN_RINGS
              }
 Pattern ;
 
@@ -47,8 +48,77 @@ typedef enum { TRANSPARENCY_UNDEFINED
 Transparency ;
 
 
+// Visibility bit planes: bit j of a row's plane word is the visibility of vertex j of that row.
+typedef enum { VISIBILITY_FROM_CAM
+             , VISIBILITY_FROM_LIGHT1
+             , VISIBILITY_FROM_LIGHT2
+             , VISIBILITY_FROM_LIGHT3
+             , VISIBILITY_CULLED          // Off screen, and so are all its lattice segments: no occlusion test, nothing drawn.
+             , VISIBILITY_PLANES
+             }
+VisibilityPlane ;
+
+// Frame computation stages, each one run in resumable chunks from its own timer callback.
+typedef enum { FRAME_STAGE_IDLE          // Waiting for the next animation tick.
+             , FRAME_STAGE_Z             // Lattice z, FRAME_CHUNK_ROWS * FRAME_Z_CHUNK_FACTOR rows per chunk.
+             , FRAME_STAGE_PROJECT       // Cam update, screen projection and culling.
+             , FRAME_STAGE_VISIBILITY    // Occlusion tests, FRAME_CHUNK_ROWS rows per chunk.
+             }
+FrameStage ;
+
+// Lattice arrays a mode change left stale, for the frame under way to recompute.
+typedef enum { FRAME_DIRTY_DIST2OSC = 1 << 0    // Distances to the oscillator, ahead of the first z row.
+             , FRAME_DIRTY_PALETTE  = 1 << 1    // All palette indices, once z and visibility are complete.
+             }
+FrameDirty ;
+
+// Lattice views are the number of row parities iterated: the major rows only, or the major then the minor rows.
+typedef enum { LATTICE_MAJOR = 1
+             , LATTICE_FULL  = 2
+             }
+LatticeView ;
+
+// Frame production modes, by decreasing frame rate.
+typedef enum { ACTIVITY_ACTIVE           // Full frame rate.
+             , ACTIVITY_IDLE             // Nothing moving: frame interval doubled up to ACTIVITY_IDLE_LEVEL_MAX times.
+             , ACTIVITY_OBSCURED         // App out of focus (notification, menu...): no frames at all.
+             , ACTIVITY_MODES
+             }
+ActivityMode ;
+
+// Click handlers a trace records, by id (6 bits at most).
+typedef enum { TRACE_CLICK_COLORIZATION
+             , TRACE_CLICK_PATTERN
+             , TRACE_CLICK_OSCILLATOR
+             , TRACE_CLICK_GRID_RESOLUTION
+             , TRACE_CLICK_TRANSPARENCY
+             , TRACE_CLICK_ANTIALIASING
+             , TRACE_CLICK_INVERT
+             , TRACE_CLICKS
+             }
+TraceClick ;
+
+
+// Stages checked against the double precision reference (PRECISION), with a magnitude error each.
+typedef enum { PRECISION_COORD
+             , PRECISION_DIST
+             , PRECISION_HEIGHT
+             , PRECISION_PROJECT
+             , PRECISION_STAGES
+             }
+PrecisionStage ;
+
+
 /* -----------   STRUCTS   ----------- */
 
+// Screen point as an offset from the screen center, for the low RAM grid storage profile (GRID_COMPACT).
+typedef struct
+{
+  int8_t x ;
+  int8_t y ;
+} ScreenOffset ;
+
+
 typedef struct
 {
   bool fromCam   :1 ;
@@ -74,5 +144,14 @@ typedef struct
   Q3          world ;
   Q           dist2osc ;
   Visibility  visibility ;
+  uint8_t     paletteIndex ;
   GPoint      screen ;
-} Fuxel ;
\ No newline at end of file
+} Fuxel ;
+
+
+typedef struct
+{
+  double    max ;
+  double    sum ;
+  uint32_t  num ;
+} PrecisionError ;
@@ -0,0 +1,31 @@
+/*
+   WatchApp: Ripples 3D
+   File    : index.js
+   Notes   : Phone side of the telemetry channel (TELEMETRY in src/c/Config.h): collects the frame records as CSV.
+           : Every batch is also logged raw, "telemetry: {...}" lines that tools/telemetry_replay.js replays.
+*/
+
+var telemetry = require( './telemetry' ) ;
+
+// Batches between summaries in the log.
+var SUMMARY_BATCHES = 30 ;
+
+var collector = new telemetry.Collector( ) ;
+
+
+Pebble.addEventListener( 'appmessage', function( e )
+{
+  if (collector.add( e.payload ) < 0)
+    return ;
+
+  console.log( 'telemetry: ' + JSON.stringify( { TelemetryFields : e.payload.TelemetryFields
+                                               , TelemetryDropped: e.payload.TelemetryDropped
+                                               , TelemetryFrames : e.payload.TelemetryFrames
+                                               } ) ) ;
+
+  if (collector.batches % SUMMARY_BATCHES === 0)
+    console.log( collector.summary( ) ) ;
+} ) ;
+
+
+module.exports = collector ;
@@ -0,0 +1,109 @@
+/*
+   WatchApp: Ripples 3D
+   File    : telemetry.js
+   Notes   : Decodes the telemetry batches sent by src/c/Telemetry.c and aggregates their frame records as CSV.
+*/
+
+// Frame record fields, same order as TelemetryField in src/c/Telemetry.h. Timings are in profile clock ticks.
+var FIELDS = [ 'steps'
+             , 'oscillator', 'grid_z', 'camera', 'project', 'visibility', 'draw'
+             , 'f_xy', 'q_div', 'q_sqrt', 'tests', 'probes', 'terminator_steps', 'segments'
+             ] ;
+
+// Frame records kept at most, the oldest dropped first.
+var ROWS_MAX = 4096 ;
+
+
+function Collector( )
+{
+  this.rows    = [ ] ;
+  this.batches = 0 ;
+  this.dropped = 0 ;
+}
+
+
+// Appends the frame records of one AppMessage payload. Returns the number of records, -1 if not a telemetry batch.
+Collector.prototype.add = function( payload )
+{
+  var frames = payload.TelemetryFrames ;
+
+  if (frames === undefined)
+    return -1 ;
+
+  if (payload.TelemetryFields !== FIELDS.length)
+  {
+    console.log( 'telemetry: ' + payload.TelemetryFields + ' fields per record, expected ' + FIELDS.length + ', batch ignored' ) ;
+    return -1 ;
+  }
+
+  var recordBytes = 2 * FIELDS.length ;
+  var records     = Math.floor( frames.length / recordBytes ) ;
+
+  for (var r = 0  ;  r < records  ;  ++r)
+  {
+    var row = [ this.batches ] ;
+
+    for (var f = 0  ;  f < FIELDS.length  ;  ++f)
+    {
+      var at = r * recordBytes + 2 * f ;
+
+      row.push( frames[at] | (frames[at+1] << 8) ) ;   // Little endian uint16.
+    }
+
+    this.rows.push( row ) ;
+  }
+
+  if (this.rows.length > ROWS_MAX)
+    this.rows.splice( 0, this.rows.length - ROWS_MAX ) ;
+
+  this.batches += 1 ;
+  this.dropped += payload.TelemetryDropped || 0 ;
+
+  return records ;
+} ;
+
+
+Collector.prototype.csv = function( )
+{
+  var lines = [ [ 'batch' ].concat( FIELDS ).join( ',' ) ] ;
+
+  for (var r = 0  ;  r < this.rows.length  ;  ++r)
+    lines.push( this.rows[r].join( ',' ) ) ;
+
+  return lines.join( '\n' ) + '\n' ;
+} ;
+
+
+// Percentile (0..100) of a field over the rows kept, nearest rank.
+Collector.prototype.percentile = function( field, p )
+{
+  var f      = FIELDS.indexOf( field ) + 1 ;
+  var values = this.rows.map( function( row ) { return row[f] ; } ).sort( function( a, b ) { return a - b ; } ) ;
+
+  if (values.length === 0)
+    return 0 ;
+
+  return values[Math.min( values.length - 1, Math.ceil( p / 100 * values.length ) - 1 )] ;
+} ;
+
+
+// One line per field: p50/p90/p99/max over the rows kept.
+Collector.prototype.summary = function( )
+{
+  var self  = this ;
+  var lines = [ this.rows.length + ' frames in ' + this.batches + ' batches, ' + this.dropped + ' dropped' ] ;
+
+  FIELDS.forEach( function( field )
+  {
+    lines.push( field + ': p50 ' + self.percentile( field, 50 )
+                      + ', p90 ' + self.percentile( field, 90 )
+                      + ', p99 ' + self.percentile( field, 99 )
+                      + ', max ' + self.percentile( field, 100 )
+              ) ;
+  } ) ;
+
+  return lines.join( '\n' ) ;
+} ;
+
+
+module.exports = { FIELDS: FIELDS, Collector: Collector } ;
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+   WatchApp: Ripples 3D
+   File    : bench_compare.py
+   Notes   : Collects the per scenario results of a BENCH build (src/c/Config.h) and compares them to a baseline.
+
+   Usage   : python3 tools/bench_compare.py [--save <json>] [--baseline <json>] [--threshold <pct>] <log>...
+           : <log> holds "bench: {...}" lines, as logged by the watch or the emulator (pebble logs), other lines are
+           : skipped. Logs of several platforms merge, the scenario ids start with the platform.
+           : --save writes the collected results as the next baseline. --baseline flags every scenario whose work
+           : counts, or stage timings past --min-ticks, grew by more than --threshold percent: exit status 1 if any.
+"""
+
+import argparse
+import json
+import sys
+
+MARKER = 'bench: {'
+
+# Same order as the "ticks" and "work" arrays of bench_scenario_report( ) in src/c/main.c.
+TICKS = [ 'oscillator', 'grid_z', 'camera', 'project', 'visibility', 'draw' ]
+WORK  = [ 'f_xy', 'q_div', 'q_sqrt', 'tests', 'probes', 'terminator_steps', 'segments' ]
+
+
+def collect( paths ):
+  results = { }
+
+  for path in paths:
+    with open( path ) as log:
+      for line in log:
+        at = line.find( MARKER )
+
+        if at < 0:
+          continue
+
+        record = json.loads( line[at + len( MARKER ) - 1:] )
+        results[record['id']] = { 'unit'  : record['unit']
+                                , 'frames': record['frames']
+                                , 'ticks' : dict( zip( TICKS, record['ticks'] ) )
+                                , 'work'  : dict( zip( WORK , record['work' ] ) )
+                                , 'heap'  : record['heap']
+                                }
+
+  return results
+
+
+def growth( old, new ):
+  return float( 'inf' ) if old == 0 else 100.0 * (new - old) / old
+
+
+def compare( baseline, results, threshold, minTicks ):
+  regressions = [ ]
+
+  for id in sorted( results ):
+    if id not in baseline:
+      print( 'new      %s' % id )
+      continue
+
+    old, new = baseline[id], results[id]
+
+    # Work counts are exact: any growth past the threshold counts. Timings only above the clock resolution noise.
+    for name in WORK:
+      if new['work'][name] > old['work'][name]  and  growth( old['work'][name], new['work'][name] ) > threshold:
+        regressions.append( (id, name, old['work'][name], new['work'][name]) )
+
+    if new['unit'] == old['unit']:
+      for name in TICKS:
+        if new['ticks'][name] - old['ticks'][name] >= minTicks  and  growth( old['ticks'][name], new['ticks'][name] ) > threshold:
+          regressions.append( (id, name, old['ticks'][name], new['ticks'][name]) )
+
+    if new['heap'] > old['heap']  and  growth( old['heap'], new['heap'] ) > threshold:
+      regressions.append( (id, 'heap', old['heap'], new['heap']) )
+
+  for id in sorted( set( baseline ) - set( results ) ):
+    print( 'missing  %s' % id )
+
+  for id, name, old, new in regressions:
+    print( 'REGRESS  %-48s %-16s %10d -> %10d  %+.1f%%' % (id, name, old, new, growth( old, new )) )
+
+  print( '%d scenarios, %d in the baseline, %d regressions past %g%%'
+       % (len( results ), len( set( results ) & set( baseline ) ), len( regressions ), threshold)
+       )
+
+  return len( regressions ) == 0
+
+
+def main( ):
+  parser = argparse.ArgumentParser( description = 'Compare BENCH results to a baseline.' )
+  parser.add_argument( 'logs', nargs = '+' )
+  parser.add_argument( '--save' )
+  parser.add_argument( '--baseline' )
+  parser.add_argument( '--threshold', type = float, default = 5.0, help = 'percent growth flagged (default 5)' )
+  parser.add_argument( '--min-ticks', type = int  , default = 2  , help = 'timing growth below this is noise (default 2)' )
+  args = parser.parse_args( )
+
+  results = collect( args.logs )
+
+  if not results:
+    sys.exit( 'no "%s...}" lines in %s' % (MARKER, ', '.join( args.logs )) )
+
+  if args.save:
+    with open( args.save, 'w' ) as out:
+      json.dump( results, out, indent = 1, sort_keys = True )
+
+  if args.baseline:
+    with open( args.baseline ) as base:
+      if not compare( json.load( base ), results, args.threshold, args.min_ticks ):
+        sys.exit( 1 )
+
+
+if __name__ == '__main__':
+  main( )
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""
+   WatchApp: Ripples 3D
+   File    : golden_compare.py
+   Notes   : Rebuilds the frames logged by a GOLDEN build (src/c/Config.h) and compares them to the golden ones.
+
+   Usage   : python3 tools/golden_compare.py [--save <dir>] [--golden <dir>] [--diff <dir>] [--tolerance <n>]
+           :                                 [--max-pixels <n>] <log>...
+           : <log> holds "golden: ..." lines, as logged by the emulator (pebble logs) or a host build, other lines are
+           : skipped. Frames are PPM images named after their ids: platform, pattern, transparency, colorization and
+           : update count. --save writes them as the golden frames. --golden compares them to the golden frames: a pixel
+           : differs if any of its channels is more than --tolerance apart, a frame fails with more than --max-pixels
+           : differing pixels, exit status 1 if any does. --diff writes an image per failed frame, the differing pixels
+           : red over the dimmed golden frame.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+MARKER = 'golden: '
+
+
+def frame_name( id ):
+  return id.replace( '/', '_' ) + '.ppm'
+
+
+def rgb( value, bits, x ):
+  # 1 bit frame buffers: 8 pixels a byte, the first one in the lowest bit. 8 bit ones: GColor8, 2 bits per channel ARGB.
+  if bits == 1:
+    return (255, 255, 255) if (value >> (x & 7)) & 1 else (0, 0, 0)
+
+  return tuple( ((value >> shift) & 3) * 85 for shift in (4, 2, 0) )
+
+
+def collect( paths ):
+  frames = { }
+  frame  = None
+
+  for path in paths:
+    with open( path ) as log:
+      for line in log:
+        at = line.find( MARKER )
+
+        if at < 0:
+          continue
+
+        fields = line[at + len( MARKER ):].split( )
+
+        if fields[0] == 'frame':
+          id, width, height, bits = fields[1], int( fields[2] ), int( fields[3] ), int( fields[4] )
+          bytesPerRow = (width + 7) // 8 if bits == 1 else width
+          frame = { 'id': id, 'width': width, 'height': height, 'bits': bits, 'rows': [ bytearray( bytesPerRow ) for y in range( height ) ] }
+
+        elif fields[0] == 'end':
+          if frame is not None  and  frame['id'] == fields[1]:
+            frames[frame['id']] = pixels( frame )
+
+          frame = None
+
+        elif frame is not None  and  re.match( r'^\d+$', fields[0] ):
+          row, offset = frame['rows'][int( fields[0] )], int( fields[1] )
+          runs        = bytes.fromhex( fields[2] )
+
+          for i in range( 0, len( runs ), 2 ):
+            length = runs[i] + 1
+            row[offset:offset + length] = bytes( [ runs[i+1] ] ) * length
+            offset += length
+
+  return frames
+
+
+def pixels( frame ):
+  bits = frame['bits']
+
+  return { 'width' : frame['width']
+         , 'height': frame['height']
+         , 'rgb'   : [ [ rgb( row[x >> 3] if bits == 1 else row[x], bits, x ) for x in range( frame['width'] ) ] for row in frame['rows'] ]
+         }
+
+
+def ppm_write( path, image ):
+  with open( path, 'wb' ) as out:
+    out.write( b'P6 %d %d 255\n' % (image['width'], image['height']) )
+    out.write( bytes( channel for row in image['rgb'] for pixel in row for channel in pixel ) )
+
+
+def ppm_read( path ):
+  with open( path, 'rb' ) as ppm:
+    data = ppm.read( )
+
+  # Exactly one white space after the header, the pixel bytes may start with white space values.
+  header = re.match( rb'P6\s+(\d+)\s+(\d+)\s+\d+\s', data )
+  width  = int( header.group( 1 ) )
+  height = int( header.group( 2 ) )
+  body   = data[header.end( ):]
+
+  return { 'width' : width
+         , 'height': height
+         , 'rgb'   : [ [ tuple( body[3*(y*width + x):3*(y*width + x) + 3] ) for x in range( width ) ] for y in range( height ) ]
+         }
+
+
+def compare( golden, frame, tolerance ):
+  if (golden['width'], golden['height']) != (frame['width'], frame['height']):
+    return None
+
+  return [ (x, y) for y in range( frame['height'] ) for x in range( frame['width'] )
+                  if max( abs( a - b ) for a, b in zip( golden['rgb'][y][x], frame['rgb'][y][x] ) ) > tolerance
+         ]
+
+
+def diff_image( golden, diffs ):
+  image = { 'width' : golden['width']
+          , 'height': golden['height']
+          , 'rgb'   : [ [ tuple( channel // 3 for channel in pixel ) for pixel in row ] for row in golden['rgb'] ]
+          }
+
+  for x, y in diffs:
+    image['rgb'][y][x] = (255, 0, 0)
+
+  return image
+
+
+def main( ):
+  parser = argparse.ArgumentParser( description = 'Compare GOLDEN frames to the golden ones.' )
+  parser.add_argument( 'logs', nargs = '+' )
+  parser.add_argument( '--save' )
+  parser.add_argument( '--golden' )
+  parser.add_argument( '--diff' )
+  parser.add_argument( '--tolerance' , type = int, default = 0, help = 'channel difference still taken as equal (default 0)' )
+  parser.add_argument( '--max-pixels', type = int, default = 0, help = 'differing pixels a frame may have (default 0)' )
+  args = parser.parse_args( )
+
+  frames = collect( args.logs )
+
+  if not frames:
+    sys.exit( 'no complete "%sframe" in %s' % (MARKER, ', '.join( args.logs )) )
+
+  if args.save:
+    os.makedirs( args.save, exist_ok = True )
+
+    for id, frame in frames.items( ):
+      ppm_write( os.path.join( args.save, frame_name( id ) ), frame )
+
+    print( '%d frames saved to %s' % (len( frames ), args.save) )
+
+  if not args.golden:
+    return
+
+  if args.diff:
+    os.makedirs( args.diff, exist_ok = True )
+
+  failed = 0
+
+  for id in sorted( frames ):
+    path = os.path.join( args.golden, frame_name( id ) )
+
+    if not os.path.exists( path ):
+      print( 'new      %s' % id )
+      continue
+
+    golden = ppm_read( path )
+    diffs  = compare( golden, frames[id], args.tolerance )
+
+    if diffs is None:
+      print( 'FAIL     %-48s size %dx%d, golden %dx%d' % (id, frames[id]['width'], frames[id]['height'], golden['width'], golden['height']) )
+      failed += 1
+
+    elif len( diffs ) > args.max_pixels:
+      print( 'FAIL     %-48s %d pixels differ' % (id, len( diffs )) )
+      failed += 1
+
+      if args.diff:
+        ppm_write( os.path.join( args.diff, frame_name( id ) ), diff_image( golden, diffs ) )
+
+  print( '%d frames, %d failed' % (len( frames ), failed) )
+
+  if failed > 0:
+    sys.exit( 1 )
+
+
+if __name__ == '__main__':
+  main( )
@@ -0,0 +1,64 @@
+#!/bin/bash
+#
+#  WatchApp: Ripples 3D
+#  File    : tools/host/build.sh
+#  Notes   : Builds src/c as a host executable, against the SDK and karambola stand-ins of tools/host.
+#
+#  Usage   : tools/host/build.sh [-p basalt|aplite|diorite|chalk] [-s <src dir>] [-o <executable>] [--] [FLAG|-FLAG]...
+#          : FLAG uncomments "//#define FLAG" in a copy of Config.h, -FLAG comments "#define FLAG" out: "--" first.
+#          : Defaults: basalt, the src/c of this tree, tools/host/build/app. See tools/host/pebble.c for the
+#          : environment variables the executable reads.
+#
+
+set -e
+
+HOST=$(cd "$(dirname "$0")" && pwd)
+PLATFORM=basalt
+SRC=$HOST/../../src/c
+OUT=$HOST/build/app
+
+while getopts "p:s:o:" option
+do
+  case $option in
+    p) PLATFORM=$OPTARG ;;
+    s) SRC=$OPTARG ;;
+    o) OUT=$OPTARG ;;
+    *) sed -n "s/^#  Usage   : /usage: /p" "$0" >&2 ; exit 2 ;;
+  esac
+done
+
+shift $((OPTIND - 1))
+
+case $PLATFORM in
+  basalt)          DEFINES="-DPBL_PLATFORM_BASALT -DPBL_COLOR -DPBL_RECT" ;;
+  aplite|diorite)  DEFINES="-DPBL_PLATFORM_${PLATFORM^^} -DPBL_BW -DPBL_RECT" ;;
+  chalk)           DEFINES="-DPBL_PLATFORM_CHALK -DPBL_COLOR -DPBL_ROUND" ;;
+  *)               echo "unknown platform $PLATFORM" >&2 ; exit 2 ;;
+esac
+
+# The Config.h flags toggled in a copy of the sources.
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cp "$SRC"/*.c "$SRC"/*.h "$WORK"
+
+for flag in "$@"
+do
+  if [[ $flag == -* ]]
+  then sed -i "s|^#define  *${flag#-}\b|//#define ${flag#-}|" "$WORK/Config.h"
+  else sed -i "s|^//#define ${flag}\b|#define  ${flag}|"       "$WORK/Config.h"
+  fi
+done
+
+mkdir -p "$(dirname "$OUT")"
+
+CFLAGS="-std=c99 -D_DEFAULT_SOURCE -O1 -g -Wall -Wno-unused-function -Wno-unused-variable -Wno-unused-but-set-variable $DEFINES -I$HOST/include"
+
+# The app's main( ), renamed, has no return statement of its own.
+for file in "$WORK"/*.c
+do
+  gcc $CFLAGS -Wno-return-type -include pebble.h -Dmain=host_app_main -I"$WORK" -c "$file" -o "${file%.c}.o"
+done
+
+gcc $CFLAGS -c "$HOST/pebble.c"    -o "$WORK/host_pebble.o"
+gcc $CFLAGS -c "$HOST/karambola.c" -o "$WORK/host_karambola.o"
+gcc "$WORK"/*.o -o "$OUT" -lm
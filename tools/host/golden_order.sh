@@ -0,0 +1,34 @@
+#!/bin/bash
+#
+#  WatchApp: Ripples 3D
+#  File    : tools/host/golden_order.sh
+#  Notes   : Renders the GOLDEN scenarios first to last and last to first (GOLDEN_REVERSED) on the host, and compares
+#          : their frames with tools/golden_compare.py: a scenario's frames must not depend on the ones run before it.
+#
+#  Usage   : tools/host/golden_order.sh [FLAG|-FLAG]...
+#          : Flags are toggled in both builds (see build.sh). Runs basalt, aplite and chalk, exit status 1 if any frame
+#          : differs at all.
+#
+
+HOST=$(cd "$(dirname "$0")" && pwd)
+REPO=$(cd "$HOST/../.." && pwd)
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+for platform in basalt aplite chalk
+do
+  for order in GOLDEN GOLDEN_REVERSED
+  do
+    rm -f "$WORK/app"
+    "$HOST/build.sh" -p $platform -o "$WORK/app" -- $order "$@" 2>&1 | grep -E "error|warning|usage|unknown"
+    HOST_FRAMES=1000000 "$WORK/app" > "$WORK/$platform.$order.log"
+  done
+done
+
+python3 "$REPO/tools/golden_compare.py" --save "$WORK/golden" "$WORK"/*.GOLDEN.log | tail -1
+python3 "$REPO/tools/golden_compare.py" --golden "$WORK/golden" "$WORK"/*.GOLDEN_REVERSED.log > "$WORK/compare.txt"
+status=$?
+
+grep -E "^FAIL|^new|failed" "$WORK/compare.txt"
+exit $status
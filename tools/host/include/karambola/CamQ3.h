@@ -0,0 +1,29 @@
+/*
+   WatchApp: Ripples 3D
+   File    : tools/host/include/karambola/CamQ3.h
+   Notes   : Host stand-in for the karambola package (CloudPebble dependency, not in this repository): perspective camera.
+           : Same names and Q16.16 layout as used by src/c, double precision where the package is fixed point.
+*/
+
+#pragma once
+
+#include "Q2.h"
+#include "Q3.h"
+
+
+typedef enum { CAM_PROJECTION_PERSPECTIVE, CAM_PROJECTION_ORTHOGRAPHIC } CamProjection ;
+
+typedef struct
+{
+  Q3             viewPoint ;
+  Q3             xAxis, yAxis, zAxis ;    // Unit film axes, zAxis from the view point towards the origin.
+  Q              zoom ;
+  CamProjection  projection ;
+} CamQ3 ;
+
+
+// Cam at viewPoint looking at the world origin, the film's y axis in the vertical plane through the z axis.
+CamQ3* CamQ3_lookAtOriginUpwards( CamQ3 *cam, const Q3 *viewPoint, const Q zoom, const CamProjection projection ) ;
+
+// Perspective projection of a world point on the cam's film.
+Q2* CamQ3_view( Q2 *film, const CamQ3 *cam, const Q3 *world ) ;
@@ -0,0 +1,16 @@
+/*
+   WatchApp: Ripples 3D
+   File    : tools/host/include/karambola/Draw2D.h
+   Notes   : Host stand-in for the karambola package (CloudPebble dependency, not in this repository): patterned lines.
+           : Same names and Q16.16 layout as used by src/c, double precision where the package is fixed point.
+*/
+
+#pragma once
+
+#include <pebble.h>
+
+
+typedef enum { INK0, INK25, INK33, INK50, INK66, INK75, INK100 } ink_t ;
+
+// INK100 a solid line, lower inks a dotted one: every third pixel.
+void Draw2D_line_pattern( GContext *gCtx, int x0, int y0, int x1, int y1, ink_t ink ) ;
@@ -0,0 +1,42 @@
+/*
+   WatchApp: Ripples 3D
+   File    : tools/host/include/karambola/Q.h
+   Notes   : Host stand-in for the karambola package (CloudPebble dependency, not in this repository): Q16.16 scalars.
+           : Same names and Q16.16 layout as used by src/c, double precision where the package is fixed point.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+
+typedef int32_t Q ;
+
+#define Q_0                 ((Q)0)
+#define Q_1                 ((Q)0x10000)
+#define Q_from_int(i)       ((Q)(i) << 16)
+#define Q_from_float(f)     ((Q)((f) * 65536.0f))
+#define Q_to_int(q)         ((q) >> 16)
+
+
+static inline
+Q
+Q_mul
+( const Q a
+, const Q b
+)
+{ return (Q)(((int64_t)a * b) >> 16) ; }
+
+
+// Saturates on division by 0.
+static inline
+Q
+Q_div
+( const Q a
+, const Q b
+)
+{ return (b != 0) ? (Q)(((int64_t)a << 16) / b) : (a >= 0) ? INT32_MAX : -INT32_MAX ; }
+
+
+// 0 for a <= 0.
+Q Q_sqrt( const Q a ) ;
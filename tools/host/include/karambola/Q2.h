@@ -0,0 +1,21 @@
+/*
+   WatchApp: Ripples 3D
+   File    : tools/host/include/karambola/Q2.h
+   Notes   : Host stand-in for the karambola package (CloudPebble dependency, not in this repository): 2D Q16.16 vectors.
+           : Same names and Q16.16 layout as used by src/c, double precision where the package is fixed point.
+*/
+
+#pragma once
+
+#include "Q.h"
+
+
+typedef struct { Q x, y ; } Q2 ;
+
+extern const Q2 Q2_origin ;
+
+
+static inline Q2* Q2_set( Q2 *r, const Q x, const Q y )            { r->x = x ;  r->y = y ;  return r ; }
+static inline Q2* Q2_add( Q2 *r, const Q2 *a, const Q2 *b )        { r->x = a->x + b->x ;  r->y = a->y + b->y ;  return r ; }
+static inline Q2* Q2_sub( Q2 *r, const Q2 *a, const Q2 *b )        { r->x = a->x - b->x ;  r->y = a->y - b->y ;  return r ; }
+static inline Q2* Q2_sca( Q2 *r, const Q k, const Q2 *a )          { r->x = Q_mul( k, a->x ) ;  r->y = Q_mul( k, a->y ) ;  return r ; }
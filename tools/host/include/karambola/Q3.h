@@ -0,0 +1,26 @@
+/*
+   WatchApp: Ripples 3D
+   File    : tools/host/include/karambola/Q3.h
+   Notes   : Host stand-in for the karambola package (CloudPebble dependency, not in this repository): 3D Q16.16 vectors.
+           : Same names and Q16.16 layout as used by src/c, double precision where the package is fixed point.
+*/
+
+#pragma once
+
+#include "Q.h"
+
+
+typedef struct { Q x, y, z ; } Q3 ;
+
+
+static inline Q3* Q3_set( Q3 *r, const Q x, const Q y, const Q z )  { r->x = x ;  r->y = y ;  r->z = z ;  return r ; }
+static inline Q3* Q3_add( Q3 *r, const Q3 *a, const Q3 *b )         { r->x = a->x + b->x ;  r->y = a->y + b->y ;  r->z = a->z + b->z ;  return r ; }
+static inline Q3* Q3_sub( Q3 *r, const Q3 *a, const Q3 *b )         { r->x = a->x - b->x ;  r->y = a->y - b->y ;  r->z = a->z - b->z ;  return r ; }
+static inline Q3* Q3_sca( Q3 *r, const Q k, const Q3 *a )           { r->x = Q_mul( k, a->x ) ;  r->y = Q_mul( k, a->y ) ;  r->z = Q_mul( k, a->z ) ;  return r ; }
+
+// a scaled to the given length.
+Q3* Q3_scaTo( Q3 *r, const Q length, const Q3 *a ) ;
+
+// a rotated around the z and x axis, angles in TRIG_MAX_ANGLE units.
+Q3* Q3_rotZ( Q3 *r, const Q3 *a, const int32_t angle ) ;
+Q3* Q3_rotX( Q3 *r, const Q3 *a, const int32_t angle ) ;
@@ -0,0 +1,24 @@
+/*
+   WatchApp: Ripples 3D
+   File    : tools/host/include/karambola/Sampler.h
+   Notes   : Host stand-in for the karambola package (CloudPebble dependency, not in this repository): running sums of
+           : the last samples pushed. Used by the revisions before src/c/Accel.c, for regress.sh runs against them.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+
+typedef struct
+{ uint16_t  samplesNum ;
+  uint16_t  samplesCapacity ;
+  int32_t   samplesAcum ;
+  uint16_t  oldestIdx ;
+  int16_t   samples[] ;
+} Sampler ;
+
+
+Sampler* Sampler_new( const uint16_t samplesCapacity ) ;
+Sampler* Sampler_free( Sampler *sampler ) ;
+void     Sampler_push( Sampler *sampler, const int16_t sample ) ;
@@ -0,0 +1,254 @@
+/*
+   WatchApp: Ripples 3D
+   File    : tools/host/include/pebble.h
+   Notes   : The subset of the Pebble SDK used by src/c, and by its past revisions regress.sh is run against, for host
+           : builds (tools/host/build.sh).
+           : Types and constants follow the SDK headers, the functions are stand-ins implemented in tools/host/pebble.c.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+
+/* -----------   Platform   ----------- */
+
+#ifdef PBL_ROUND
+  #define PBL_IF_RECT_ELSE(if_true, if_false)    (if_false)
+  #define PBL_IF_ROUND_ELSE(if_true, if_false)   (if_true)
+#else
+  #define PBL_IF_RECT_ELSE(if_true, if_false)    (if_true)
+  #define PBL_IF_ROUND_ELSE(if_true, if_false)   (if_false)
+#endif
+
+#ifdef PBL_COLOR
+  #define PBL_IF_COLOR_ELSE(if_true, if_false)   (if_true)
+#else
+  #define PBL_IF_COLOR_ELSE(if_true, if_false)   (if_false)
+#endif
+
+#define ACTION_BAR_WIDTH   30
+
+
+/* -----------   Logging   ----------- */
+
+enum { APP_LOG_LEVEL_ERROR = 1, APP_LOG_LEVEL_WARNING = 50, APP_LOG_LEVEL_INFO = 100, APP_LOG_LEVEL_DEBUG = 200 } ;
+
+// To stdout, one line per call.
+#define APP_LOG(level, fmt, ...)   (printf( fmt "\n", ##__VA_ARGS__ ))
+
+
+/* -----------   Trigonometry   ----------- */
+
+#define TRIG_MAX_ANGLE   0x10000
+#define TRIG_MAX_RATIO   0xffff
+
+int32_t cos_lookup( int32_t angle ) ;
+int32_t sin_lookup( int32_t angle ) ;
+
+
+/* -----------   Geometry and colors   ----------- */
+
+typedef struct { int16_t x, y ; } GPoint ;
+typedef struct { int16_t w, h ; } GSize ;
+typedef struct { GPoint origin ; GSize size ; } GRect ;
+
+#define GPoint(x, y)         ((GPoint){ (x), (y) })
+#define GPointZero           GPoint(0, 0)
+#define GRect(x, y, w, h)    ((GRect){ { (x), (y) }, { (w), (h) } })
+
+static inline bool gpoint_equal( const GPoint *a, const GPoint *b )  { return a->x == b->x  &&  a->y == b->y ; }
+
+// ARGB, 2 bits per channel.
+typedef union { uint8_t argb ; struct { uint8_t b:2, g:2, r:2, a:2 ; } ; } GColor8 ;
+typedef GColor8 GColor ;
+
+#define GColorClear           ((GColor8){ .argb = 0x00 })
+#define GColorBlack           ((GColor8){ .argb = 0xC0 })
+#define GColorWhite           ((GColor8){ .argb = 0xFF })
+#define GColorDarkGray        ((GColor8){ .argb = 0xD5 })
+#define GColorLightGray       ((GColor8){ .argb = 0xEA })
+#define GColorRed             ((GColor8){ .argb = 0xF0 })
+#define GColorMagenta         ((GColor8){ .argb = 0xF3 })
+#define GColorMelon           ((GColor8){ .argb = 0xFA })
+#define GColorYellow          ((GColor8){ .argb = 0xFC })
+#define GColorGreen           ((GColor8){ .argb = 0xCC })
+#define GColorVividCerulean   ((GColor8){ .argb = 0xCB })
+#define GColorCyan            ((GColor8){ .argb = 0xCF })
+
+static inline bool gcolor_equal( GColor a, GColor b )  { return a.argb == b.argb ; }
+
+
+/* -----------   Graphics   ----------- */
+
+typedef struct GContext GContext ;
+typedef struct GBitmap  GBitmap ;
+
+typedef enum { GBitmapFormat1Bit
+             , GBitmapFormat8Bit
+             , GBitmapFormat1BitPalette
+             , GBitmapFormat2BitPalette
+             , GBitmapFormat4BitPalette
+             , GBitmapFormat8BitCircular
+             }
+GBitmapFormat ;
+
+typedef struct { uint8_t *data ; int16_t min_x ; int16_t max_x ; } GBitmapDataRowInfo ;
+
+typedef struct { uint32_t num_points ; GPoint *points ; int32_t rotation ; GPoint offset ; } GPath ;
+
+#define GCornerNone   0
+
+void graphics_context_set_stroke_color( GContext *ctx, GColor color ) ;
+void graphics_context_set_fill_color( GContext *ctx, GColor color ) ;
+void graphics_context_set_antialiased( GContext *ctx, bool enable ) ;
+void graphics_draw_pixel( GContext *ctx, GPoint point ) ;
+void graphics_draw_line( GContext *ctx, GPoint p0, GPoint p1 ) ;
+void graphics_fill_rect( GContext *ctx, GRect rect, uint16_t corner_radius, int corner_mask ) ;
+void gpath_draw_outline_open( GContext *ctx, GPath *path ) ;
+
+GBitmap*           graphics_capture_frame_buffer( GContext *ctx ) ;
+bool               graphics_release_frame_buffer( GContext *ctx, GBitmap *buffer ) ;
+GBitmapDataRowInfo gbitmap_get_data_row_info( const GBitmap *bitmap, uint16_t y ) ;
+GRect              gbitmap_get_bounds( const GBitmap *bitmap ) ;
+GBitmapFormat      gbitmap_get_format( const GBitmap *bitmap ) ;
+
+
+/* -----------   Windows and layers   ----------- */
+
+typedef struct Layer          Layer ;
+typedef struct Window         Window ;
+typedef struct ActionBarLayer ActionBarLayer ;
+
+typedef void (*LayerUpdateProc)( Layer *layer, GContext *ctx ) ;
+typedef void (*WindowHandler)( Window *window ) ;
+
+typedef struct { WindowHandler load, appear, disappear, unload ; } WindowHandlers ;
+
+Layer* layer_create( GRect frame ) ;
+void   layer_destroy( Layer *layer ) ;
+void   layer_mark_dirty( Layer *layer ) ;
+void   layer_set_update_proc( Layer *layer, LayerUpdateProc update_proc ) ;
+void   layer_add_child( Layer *parent, Layer *child ) ;
+GRect  layer_get_frame( const Layer *layer ) ;
+GRect  layer_get_bounds( const Layer *layer ) ;
+GRect  layer_get_unobstructed_bounds( const Layer *layer ) ;
+
+Window* window_create( ) ;
+void    window_destroy( Window *window ) ;
+void    window_set_background_color( Window *window, GColor color ) ;
+void    window_set_window_handlers( Window *window, WindowHandlers handlers ) ;
+void    window_stack_push( Window *window, bool animated ) ;
+bool    window_stack_remove( Window *window, bool animated ) ;
+Layer*  window_get_root_layer( const Window *window ) ;
+
+
+/* -----------   Buttons   ----------- */
+
+typedef enum { BUTTON_ID_BACK, BUTTON_ID_UP, BUTTON_ID_SELECT, BUTTON_ID_DOWN, NUM_BUTTONS } ButtonId ;
+
+typedef void *ClickRecognizerRef ;
+typedef void (*ClickHandler)( ClickRecognizerRef recognizer, void *context ) ;
+typedef void (*ClickConfigProvider)( void *context ) ;
+
+void window_single_click_subscribe( ButtonId button_id, ClickHandler handler ) ;
+void window_long_click_subscribe( ButtonId button_id, uint16_t delay_ms, ClickHandler down_handler, ClickHandler up_handler ) ;
+void window_multi_click_subscribe( ButtonId button_id, uint8_t min_clicks, uint8_t max_clicks, uint16_t timeout
+                                 , bool last_click_only, ClickHandler handler
+                                 ) ;
+
+ActionBarLayer* action_bar_layer_create( ) ;
+void            action_bar_layer_set_background_color( ActionBarLayer *action_bar, GColor color ) ;
+void            action_bar_layer_set_click_config_provider( ActionBarLayer *action_bar, ClickConfigProvider provider ) ;
+void            action_bar_layer_add_to_window( ActionBarLayer *action_bar, Window *window ) ;
+
+
+/* -----------   Timers, clock and event loop   ----------- */
+
+typedef struct AppTimer AppTimer ;
+typedef void (*AppTimerCallback)( void *data ) ;
+
+AppTimer* app_timer_register( uint32_t timeout_ms, AppTimerCallback callback, void *data ) ;
+void      app_timer_cancel( AppTimer *timer ) ;
+
+uint16_t time_ms( time_t *t_utc, uint16_t *out_ms ) ;
+
+void app_event_loop( ) ;
+
+
+/* -----------   Sensors and services   ----------- */
+
+typedef struct { int16_t x, y, z ; bool did_vibrate ; uint64_t timestamp ; } AccelData ;
+
+typedef enum { ACCEL_AXIS_X, ACCEL_AXIS_Y, ACCEL_AXIS_Z } AccelAxisType ;
+
+typedef enum { ACCEL_SAMPLING_10HZ  =  10
+             , ACCEL_SAMPLING_25HZ  =  25
+             , ACCEL_SAMPLING_50HZ  =  50
+             , ACCEL_SAMPLING_100HZ = 100
+             }
+AccelSamplingRate ;
+
+typedef void (*AccelDataHandler)( AccelData *data, uint32_t num_samples ) ;
+typedef void (*AccelTapHandler)( AccelAxisType axis, int32_t direction ) ;
+
+int  accel_service_set_sampling_rate( AccelSamplingRate rate ) ;
+int  accel_service_peek( AccelData *data ) ;
+void accel_data_service_subscribe( uint32_t samples_per_update, AccelDataHandler handler ) ;
+void accel_data_service_unsubscribe( ) ;
+void accel_tap_service_subscribe( AccelTapHandler handler ) ;
+void accel_tap_service_unsubscribe( ) ;
+
+typedef struct { void (*will_focus)( bool in_focus ) ; void (*did_focus)( bool in_focus ) ; } AppFocusHandlers ;
+
+void app_focus_service_subscribe_handlers( AppFocusHandlers handlers ) ;
+void app_focus_service_unsubscribe( ) ;
+
+size_t heap_bytes_free( ) ;
+size_t heap_bytes_used( ) ;
+
+
+/* -----------   Persistent storage   ----------- */
+
+#define PERSIST_DATA_MAX_LENGTH   256
+
+int     persist_write_data( uint32_t key, const void *data, size_t size ) ;
+int     persist_read_data( uint32_t key, void *buffer, size_t buffer_size ) ;
+int     persist_write_int( uint32_t key, int32_t value ) ;
+int32_t persist_read_int( uint32_t key ) ;
+bool    persist_exists( uint32_t key ) ;
+int     persist_delete( uint32_t key ) ;
+
+
+/* -----------   AppMessage   ----------- */
+
+typedef struct DictionaryIterator DictionaryIterator ;
+
+typedef enum { APP_MSG_OK = 0, APP_MSG_BUSY = 64 } AppMessageResult ;
+typedef enum { DICT_OK = 0 } DictionaryResult ;
+
+typedef void (*AppMessageOutboxSent)( DictionaryIterator *iterator, void *context ) ;
+typedef void (*AppMessageOutboxFailed)( DictionaryIterator *iterator, AppMessageResult reason, void *context ) ;
+
+// Keys of package.json's messageKeys.
+#define MESSAGE_KEY_TelemetryFields    10000
+#define MESSAGE_KEY_TelemetryDropped   10001
+#define MESSAGE_KEY_TelemetryFrames    10002
+
+AppMessageResult       app_message_open( uint32_t size_inbound, uint32_t size_outbound ) ;
+AppMessageResult       app_message_outbox_begin( DictionaryIterator **iterator ) ;
+AppMessageResult       app_message_outbox_send( ) ;
+AppMessageOutboxSent   app_message_register_outbox_sent( AppMessageOutboxSent sent_callback ) ;
+AppMessageOutboxFailed app_message_register_outbox_failed( AppMessageOutboxFailed failed_callback ) ;
+
+uint32_t         dict_calc_buffer_size( const uint8_t tuple_count, ... ) ;
+DictionaryResult dict_write_uint8( DictionaryIterator *iterator, uint32_t key, uint8_t value ) ;
+DictionaryResult dict_write_uint16( DictionaryIterator *iterator, uint32_t key, uint16_t value ) ;
+DictionaryResult dict_write_uint32( DictionaryIterator *iterator, uint32_t key, uint32_t value ) ;
+DictionaryResult dict_write_data( DictionaryIterator *iterator, uint32_t key, const uint8_t *data, uint16_t size ) ;
@@ -0,0 +1,186 @@
+/*
+   WatchApp: Ripples 3D
+   File    : tools/host/karambola.c
+   Notes   : Host stand-ins for the karambola package functions and the SDK trigonometry, see include/karambola/.
+           : Backed by double precision libm: figures measured through them (Q_sqrt( ) errors, projections) are those of
+           : the stand-ins, not of the watch's fixed point tables and kernels.
+*/
+
+#include <math.h>
+#include <pebble.h>
+#include <karambola/Q2.h>
+#include <karambola/Q3.h>
+#include <karambola/CamQ3.h>
+#include <karambola/Draw2D.h>
+#include <karambola/Sampler.h>
+
+#ifndef M_PI
+  #define M_PI   3.14159265358979323846
+#endif
+
+
+const Q2 Q2_origin = { Q_0, Q_0 } ;
+
+
+int32_t
+cos_lookup
+( int32_t angle )
+{ return (int32_t)lround( cos( 2.0 * M_PI * (angle & 0xFFFF) / TRIG_MAX_ANGLE ) * 65536.0 ) ; }
+
+
+int32_t
+sin_lookup
+( int32_t angle )
+{ return (int32_t)lround( sin( 2.0 * M_PI * (angle & 0xFFFF) / TRIG_MAX_ANGLE ) * 65536.0 ) ; }
+
+
+Q
+Q_sqrt
+( const Q a )
+{ return (a <= Q_0) ? Q_0 : (Q)sqrt( (double)a * 65536.0 ) ; }
+
+
+Q3*
+Q3_scaTo
+( Q3       *r
+, const Q   length
+, const Q3 *a
+)
+{
+  const double norm = sqrt( (double)a->x * a->x + (double)a->y * a->y + (double)a->z * a->z ) ;
+  const double k    = length / norm ;
+
+  return Q3_set( r, (Q)(a->x * k), (Q)(a->y * k), (Q)(a->z * k) ) ;
+}
+
+
+Q3*
+Q3_rotZ
+( Q3           *r
+, const Q3     *a
+, const int32_t angle
+)
+{
+  const Q c = cos_lookup( angle ) ;
+  const Q s = sin_lookup( angle ) ;
+
+  return Q3_set( r, Q_mul( c, a->x ) - Q_mul( s, a->y ), Q_mul( s, a->x ) + Q_mul( c, a->y ), a->z ) ;
+}
+
+
+Q3*
+Q3_rotX
+( Q3           *r
+, const Q3     *a
+, const int32_t angle
+)
+{
+  const Q c = cos_lookup( angle ) ;
+  const Q s = sin_lookup( angle ) ;
+
+  return Q3_set( r, a->x, Q_mul( c, a->y ) - Q_mul( s, a->z ), Q_mul( s, a->y ) + Q_mul( c, a->z ) ) ;
+}
+
+
+static
+Q3
+cam_cross
+( const Q3 a
+, const Q3 b
+)
+{
+  Q3 r ;
+
+  return *Q3_set( &r, Q_mul( a.y, b.z ) - Q_mul( a.z, b.y ), Q_mul( a.z, b.x ) - Q_mul( a.x, b.z ), Q_mul( a.x, b.y ) - Q_mul( a.y, b.x ) ) ;
+}
+
+
+static
+Q
+cam_dot
+( const Q3 a
+, const Q3 b
+)
+{ return Q_mul( a.x, b.x ) + Q_mul( a.y, b.y ) + Q_mul( a.z, b.z ) ; }
+
+
+CamQ3*
+CamQ3_lookAtOriginUpwards
+( CamQ3               *cam
+, const Q3            *viewPoint
+, const Q              zoom
+, const CamProjection  projection
+)
+{
+  const Q3 forward = { -viewPoint->x, -viewPoint->y, -viewPoint->z } ;
+  const Q3 up      = { Q_0, Q_0, Q_1 } ;
+
+  cam->viewPoint  = *viewPoint ;
+  cam->zoom       = zoom ;
+  cam->projection = projection ;
+
+  Q3_scaTo( &cam->zAxis, Q_1, &forward ) ;
+
+  const Q3 xAxis = cam_cross( cam->zAxis, up ) ;
+
+  Q3_scaTo( &cam->xAxis, Q_1, &xAxis ) ;
+  cam->yAxis = cam_cross( cam->xAxis, cam->zAxis ) ;
+
+  return cam ;
+}
+
+
+Q2*
+CamQ3_view
+( Q2          *film
+, const CamQ3 *cam
+, const Q3    *world
+)
+{
+  Q3 d ;  Q3_sub( &d, world, &cam->viewPoint ) ;
+
+  const Q z = cam_dot( d, cam->zAxis ) ;
+
+  film->x =  Q_mul( cam->zoom, Q_div( cam_dot( d, cam->xAxis ), z ) ) ;
+  film->y = -Q_mul( cam->zoom, Q_div( cam_dot( d, cam->yAxis ), z ) ) ;
+
+  return film ;
+}
+
+
+Sampler*
+Sampler_new
+( const uint16_t samplesCapacity )
+{
+  Sampler *sampler = calloc( 1, sizeof(Sampler) + samplesCapacity * sizeof(int16_t) ) ;
+
+  sampler->samplesCapacity = samplesCapacity ;
+
+  return sampler ;
+}
+
+
+// Nothing held besides the sampler itself, left to the caller to free( ).
+Sampler*
+Sampler_free
+( Sampler *sampler )
+{ return sampler ; }
+
+
+void
+Sampler_push
+( Sampler       *sampler
+, const int16_t  sample
+)
+{
+  if (sampler->samplesNum < sampler->samplesCapacity)
+    sampler->samples[sampler->samplesNum++] = sample ;
+  else
+  {
+    sampler->samplesAcum -= sampler->samples[sampler->oldestIdx] ;
+    sampler->samples[sampler->oldestIdx] = sample ;
+    sampler->oldestIdx = (sampler->oldestIdx + 1) % sampler->samplesCapacity ;
+  }
+
+  sampler->samplesAcum += sample ;
+}
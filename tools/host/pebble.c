@@ -0,0 +1,890 @@
+/*
+   WatchApp: Ripples 3D
+   File    : tools/host/pebble.c
+   Notes   : Host stand-ins for the Pebble SDK calls of src/c, and an event loop driving the app off a simulated clock.
+           : The frame buffer is the platform's (-DPBL_ROUND 180x180 masked to the display circle, 144x168 otherwise),
+           : drawn by integer Bresenham lines: pixel exact for the app's own logic, not for the firmware's rasterizer.
+
+   Environment, all optional:
+           : HOST_FRAMES     frames to render before exiting (default 100).
+           : HOST_SCRIPT     button clicks, "frame:button,...": after that frame is drawn, u s d single click UP SELECT
+           :                 DOWN, U S D long click them, m double click SELECT, H hold SELECT 2 s, r redraw the last
+           :                 layer drawn as the system would. "frame+n:button" waits n more timer callbacks, for the
+           :                 middle of the next frame's chunks.
+           : HOST_ACCEL      "still" for a watch lying still, a slow wrist sway otherwise.
+           : HOST_HEAP       heap_bytes_free( ) (default 60000).
+           : HOST_PERSIST    file keeping the persistent storage between runs.
+           : HOST_VERBOSE    logs each frame's running hash to stderr.
+           : HOST_PPM        file to write the last frame to.
+           : HOST_TELEMETRY  logs the AppMessage dictionaries sent, as "telemetry: {...}" JSON lines.
+           : Exits with "host:: <frames> frames, hash <running FNV-1a of all the frames>, <SDK draw calls> draw calls".
+*/
+
+#include <math.h>
+#include <stdarg.h>
+#include <pebble.h>
+#include <karambola/Draw2D.h>
+
+
+/* -----------   Frame buffer   ----------- */
+
+#ifdef PBL_ROUND
+  #define HOST_W   180
+  #define HOST_H   180
+#else
+  #define HOST_W   144
+  #define HOST_H   168
+#endif
+
+struct GContext { GColor stroke, fill ; bool isAntialiased ; } ;
+struct GBitmap  { int unused ; } ;
+
+// GColor8 bytes, or on B&W rows of 1 bit pixels packed from the first byte on, the leftmost in the lowest bit.
+static uint8_t          s_host_fb[HOST_H][HOST_W] ;
+static struct GContext  s_host_ctx ;
+static struct GBitmap   s_host_fbBitmap ;
+static uint64_t         s_host_drawCalls ;
+
+
+// Drawable columns of a row: the display circle on round platforms.
+static
+int
+host_row_xMin
+( const int y )
+{
+#ifdef PBL_ROUND
+  const double dy = y + 0.5 - HOST_H / 2 ;
+  const int    x  = (int)floor( HOST_W / 2 - sqrt( (HOST_H / 2) * (HOST_H / 2) - dy * dy ) + 0.5 ) ;
+
+  return (x < 0) ? 0 : x ;
+#else
+  return 0 ;
+#endif
+}
+
+
+static
+int
+host_row_xMax
+( const int y )
+{ return HOST_W - 1 - host_row_xMin( y ) ; }
+
+
+static
+void
+host_pixel
+( const int    x
+, const int    y
+, const GColor color
+)
+{
+  if (y < 0  ||  y >= HOST_H  ||  x < host_row_xMin( y )  ||  x > host_row_xMax( y ))
+    return ;
+
+#ifdef PBL_COLOR
+  s_host_fb[y][x] = color.argb ;
+#else
+  const uint8_t mask = 1 << (x & 7) ;
+
+  if (gcolor_equal( color, GColorWhite ))
+    s_host_fb[y][x >> 3] |= mask ;
+  else
+    s_host_fb[y][x >> 3] &= ~mask ;
+#endif
+}
+
+
+// Integer Bresenham, one pixel out of every nth drawn.
+static
+void
+host_line
+( int          x0
+, int          y0
+, const int    x1
+, const int    y1
+, const GColor color
+, const int    nth
+)
+{
+  const int dx = abs( x1 - x0 ), sx = (x0 < x1) ? 1 : -1 ;
+  const int dy = -abs( y1 - y0 ), sy = (y0 < y1) ? 1 : -1 ;
+  int       err = dx + dy ;
+
+  for (int n = 0  ;  ;  ++n)
+  {
+    if (n % nth == 0)
+      host_pixel( x0, y0, color ) ;
+
+    if (x0 == x1  &&  y0 == y1)
+      break ;
+
+    const int e2 = 2 * err ;
+
+    if (e2 >= dy)  { err += dy ;  x0 += sx ; }
+    if (e2 <= dx)  { err += dx ;  y0 += sy ; }
+  }
+}
+
+
+void graphics_context_set_stroke_color( GContext *ctx, GColor color )  { ctx->stroke = color ; }
+void graphics_context_set_fill_color( GContext *ctx, GColor color )    { ctx->fill   = color ; }
+void graphics_context_set_antialiased( GContext *ctx, bool enable )    { ctx->isAntialiased = enable ; }
+
+
+void
+graphics_draw_pixel
+( GContext *ctx
+, GPoint    point
+)
+{
+  ++s_host_drawCalls ;
+  host_pixel( point.x, point.y, ctx->stroke ) ;
+}
+
+
+void
+graphics_fill_rect
+( GContext *ctx
+, GRect     rect
+, uint16_t  corner_radius
+, int       corner_mask
+)
+{
+  for (int y = rect.origin.y  ;  y < rect.origin.y + rect.size.h  ;  ++y)
+    for (int x = rect.origin.x  ;  x < rect.origin.x + rect.size.w  ;  ++x)
+      host_pixel( x, y, ctx->fill ) ;
+}
+
+
+void
+graphics_draw_line
+( GContext *ctx
+, GPoint    p0
+, GPoint    p1
+)
+{
+  ++s_host_drawCalls ;
+  host_line( p0.x, p0.y, p1.x, p1.y, ctx->stroke, 1 ) ;
+}
+
+
+void
+gpath_draw_outline_open
+( GContext *ctx
+, GPath    *path
+)
+{
+  ++s_host_drawCalls ;
+
+  for (uint32_t p = 1  ;  p < path->num_points  ;  ++p)
+    host_line( path->points[p-1].x, path->points[p-1].y, path->points[p].x, path->points[p].y, ctx->stroke, 1 ) ;
+}
+
+
+void
+Draw2D_line_pattern
+( GContext *gCtx
+, int       x0
+, int       y0
+, int       x1
+, int       y1
+, ink_t     ink
+)
+{
+  ++s_host_drawCalls ;
+  host_line( x0, y0, x1, y1, gCtx->stroke, (ink == INK100) ? 1 : 3 ) ;
+}
+
+
+GBitmap*
+graphics_capture_frame_buffer
+( GContext *ctx )
+{
+  ++s_host_drawCalls ;
+  return &s_host_fbBitmap ;
+}
+
+
+bool graphics_release_frame_buffer( GContext *ctx, GBitmap *buffer )  { return true ; }
+
+GRect gbitmap_get_bounds( const GBitmap *bitmap )  { return GRect( 0, 0, HOST_W, HOST_H ) ; }
+
+
+GBitmapDataRowInfo
+gbitmap_get_data_row_info
+( const GBitmap *bitmap
+, uint16_t       y
+)
+{ return (GBitmapDataRowInfo){ .data = s_host_fb[y], .min_x = host_row_xMin( y ), .max_x = host_row_xMax( y ) } ; }
+
+
+GBitmapFormat
+gbitmap_get_format
+( const GBitmap *bitmap )
+{ return PBL_IF_COLOR_ELSE(PBL_IF_ROUND_ELSE(GBitmapFormat8BitCircular, GBitmapFormat8Bit), GBitmapFormat1Bit) ; }
+
+
+/* -----------   Simulated clock and timers   ----------- */
+
+#define HOST_TIMERS_MAX   64
+
+struct AppTimer { uint64_t dueMs ; AppTimerCallback callback ; void *data ; bool isArmed ; } ;
+
+static uint64_t         s_host_nowMs = 1000000 ;
+static struct AppTimer  s_host_timers[HOST_TIMERS_MAX] ;
+
+
+uint16_t
+time_ms
+( time_t   *t_utc
+, uint16_t *out_ms
+)
+{
+  if (t_utc  != NULL)  *t_utc  = s_host_nowMs / 1000 ;
+  if (out_ms != NULL)  *out_ms = s_host_nowMs % 1000 ;
+
+  return s_host_nowMs % 1000 ;
+}
+
+
+AppTimer*
+app_timer_register
+( uint32_t          timeout_ms
+, AppTimerCallback  callback
+, void             *data
+)
+{
+  for (int t = 0  ;  t < HOST_TIMERS_MAX  ;  ++t)
+    if (!s_host_timers[t].isArmed)
+    {
+      s_host_timers[t] = (struct AppTimer){ s_host_nowMs + timeout_ms, callback, data, true } ;
+      return &s_host_timers[t] ;
+    }
+
+  fprintf( stderr, "host:: more than %d timers armed\n", HOST_TIMERS_MAX ) ;
+  exit( 2 ) ;
+}
+
+
+void app_timer_cancel( AppTimer *timer )  { timer->isArmed = false ; }
+
+
+/* -----------   Windows, layers and buttons   ----------- */
+
+struct Layer          { GRect frame ; LayerUpdateProc updateProc ; } ;
+struct Window         { Layer root ; WindowHandlers handlers ; } ;
+struct ActionBarLayer { ClickConfigProvider clickConfigProvider ; } ;
+
+static Layer        *s_host_dirtyLayer ;
+static Layer        *s_host_drawnLayer ;
+static ClickHandler  s_host_singleClick[NUM_BUTTONS] ;
+static ClickHandler  s_host_longClick  [NUM_BUTTONS] ;
+static ClickHandler  s_host_longUpClick[NUM_BUTTONS] ;
+static ClickHandler  s_host_multiClick [NUM_BUTTONS] ;
+
+
+Layer*
+layer_create
+( GRect frame )
+{
+  Layer *layer = calloc( 1, sizeof(Layer) ) ;
+
+  layer->frame = frame ;
+
+  return layer ;
+}
+
+
+void  layer_destroy( Layer *layer )                                  { free( layer ) ; }
+void  layer_mark_dirty( Layer *layer )                               { s_host_dirtyLayer = layer ; }
+void  layer_set_update_proc( Layer *layer, LayerUpdateProc proc )    { layer->updateProc = proc ; }
+void  layer_add_child( Layer *parent, Layer *child )                 { }
+GRect layer_get_frame( const Layer *layer )                          { return layer->frame ; }
+GRect layer_get_bounds( const Layer *layer )                         { return (GRect){ GPointZero, layer->frame.size } ; }
+GRect layer_get_unobstructed_bounds( const Layer *layer )            { return layer_get_bounds( layer ) ; }
+
+
+Window*
+window_create
+( )
+{
+  Window *window = calloc( 1, sizeof(Window) ) ;
+
+  window->root.frame = GRect( 0, 0, HOST_W, HOST_H ) ;
+
+  return window ;
+}
+
+
+void   window_destroy( Window *window )                                      { free( window ) ; }
+void   window_set_background_color( Window *window, GColor color )           { }
+void   window_set_window_handlers( Window *window, WindowHandlers handlers ) { window->handlers = handlers ; }
+Layer* window_get_root_layer( const Window *window )                         { return (Layer *)&window->root ; }
+
+
+void
+window_stack_push
+( Window *window
+, bool    animated
+)
+{
+  if (window->handlers.load != NULL)
+    window->handlers.load( window ) ;
+}
+
+
+bool
+window_stack_remove
+( Window *window
+, bool    animated
+)
+{
+  if (window->handlers.unload != NULL)
+    window->handlers.unload( window ) ;
+
+  return true ;
+}
+
+
+void
+window_single_click_subscribe
+( ButtonId     button_id
+, ClickHandler handler
+)
+{ s_host_singleClick[button_id] = handler ; }
+
+
+void
+window_long_click_subscribe
+( ButtonId     button_id
+, uint16_t     delay_ms
+, ClickHandler down_handler
+, ClickHandler up_handler
+)
+{
+  s_host_longClick  [button_id] = down_handler ;
+  s_host_longUpClick[button_id] = up_handler ;
+}
+
+
+void
+window_multi_click_subscribe
+( ButtonId     button_id
+, uint8_t      min_clicks
+, uint8_t      max_clicks
+, uint16_t     timeout
+, bool         last_click_only
+, ClickHandler handler
+)
+{ s_host_multiClick[button_id] = handler ; }
+
+
+ActionBarLayer* action_bar_layer_create( )                                                      { return calloc( 1, sizeof(ActionBarLayer) ) ; }
+void            action_bar_layer_set_background_color( ActionBarLayer *actionBar, GColor color ) { }
+
+
+void
+action_bar_layer_set_click_config_provider
+( ActionBarLayer      *actionBar
+, ClickConfigProvider  provider
+)
+{ actionBar->clickConfigProvider = provider ; }
+
+
+void
+action_bar_layer_add_to_window
+( ActionBarLayer *actionBar
+, Window         *window
+)
+{
+  if (actionBar->clickConfigProvider != NULL)
+    actionBar->clickConfigProvider( NULL ) ;
+}
+
+
+/* -----------   Sensors and services   ----------- */
+
+static AccelDataHandler  s_host_accelHandler ;
+static uint32_t          s_host_accelBatch    = 1 ;
+static uint32_t          s_host_accelPeriodMs = 40 ;    // 25Hz, the SDK default.
+static uint64_t          s_host_accelLastMs ;
+
+
+static
+AccelData
+host_accel_sample
+( )
+{
+  const char  *mode = getenv( "HOST_ACCEL" ) ;
+  const double t    = (mode != NULL  &&  strcmp( mode, "still" ) == 0) ? 0.0 : s_host_nowMs / 1000.0 ;
+
+  return (AccelData){ .x         = (int16_t)( -81 + 300 * sin( t * 0.7 ))
+                    , .y         = (int16_t)(-816 + 200 * cos( t * 0.5 ))
+                    , .z         = (int16_t)(-571 + 100 * sin( t * 0.3 ))
+                    , .timestamp = s_host_nowMs
+                    } ;
+}
+
+
+int
+accel_service_set_sampling_rate
+( AccelSamplingRate rate )
+{
+  s_host_accelPeriodMs = 1000 / rate ;
+  return 0 ;
+}
+
+
+int
+accel_service_peek
+( AccelData *data )
+{
+  *data = host_accel_sample( ) ;
+  return 0 ;
+}
+
+
+void
+accel_data_service_subscribe
+( uint32_t          samples_per_update
+, AccelDataHandler  handler
+)
+{
+  s_host_accelHandler = handler ;
+  s_host_accelBatch   = (samples_per_update > 0) ? samples_per_update : 1 ;
+  s_host_accelLastMs  = s_host_nowMs ;
+}
+
+
+void accel_data_service_unsubscribe( )                                  { s_host_accelHandler = NULL ; }
+void accel_tap_service_subscribe( AccelTapHandler handler )              { }
+void accel_tap_service_unsubscribe( )                                    { }
+void app_focus_service_subscribe_handlers( AppFocusHandlers handlers )   { }
+void app_focus_service_unsubscribe( )                                    { }
+
+
+size_t
+heap_bytes_free
+( )
+{
+  const char *heap = getenv( "HOST_HEAP" ) ;
+
+  return (heap != NULL) ? (size_t)atol( heap ) : 60000 ;
+}
+
+
+size_t heap_bytes_used( )  { return 1000 ; }
+
+
+/* -----------   Persistent storage   ----------- */
+
+#define HOST_PERSIST_KEYS   64    // Keys hashed modulo.
+
+static uint8_t  s_host_persist   [HOST_PERSIST_KEYS][PERSIST_DATA_MAX_LENGTH] ;
+static int      s_host_persistLen[HOST_PERSIST_KEYS] ;
+static bool     s_host_persistIsLoaded ;
+
+
+static
+void
+host_persist_load
+( )
+{
+  if (s_host_persistIsLoaded)
+    return ;
+
+  s_host_persistIsLoaded = true ;
+
+  const char *path = getenv( "HOST_PERSIST" ) ;
+  FILE       *file = (path != NULL) ? fopen( path, "rb" ) : NULL ;
+
+  if (file == NULL)
+    return ;
+
+  if (fread( s_host_persist, sizeof(s_host_persist), 1, file ) != 1  ||  fread( s_host_persistLen, sizeof(s_host_persistLen), 1, file ) != 1)
+    memset( s_host_persistLen, 0, sizeof(s_host_persistLen) ) ;
+
+  fclose( file ) ;
+}
+
+
+static
+void
+host_persist_save
+( )
+{
+  const char *path = getenv( "HOST_PERSIST" ) ;
+  FILE       *file = (path != NULL) ? fopen( path, "wb" ) : NULL ;
+
+  if (file == NULL)
+    return ;
+
+  fwrite( s_host_persist   , sizeof(s_host_persist)   , 1, file ) ;
+  fwrite( s_host_persistLen, sizeof(s_host_persistLen), 1, file ) ;
+  fclose( file ) ;
+}
+
+
+int
+persist_write_data
+( uint32_t    key
+, const void *data
+, size_t      size
+)
+{
+  host_persist_load( ) ;
+
+  if (size > PERSIST_DATA_MAX_LENGTH)
+    size = PERSIST_DATA_MAX_LENGTH ;
+
+  memcpy( s_host_persist[key % HOST_PERSIST_KEYS], data, size ) ;
+  s_host_persistLen[key % HOST_PERSIST_KEYS] = size ;
+  host_persist_save( ) ;
+
+  return size ;
+}
+
+
+int
+persist_read_data
+( uint32_t  key
+, void     *buffer
+, size_t    buffer_size
+)
+{
+  host_persist_load( ) ;
+
+  const size_t size = ((int)buffer_size < s_host_persistLen[key % HOST_PERSIST_KEYS]) ? buffer_size : (size_t)s_host_persistLen[key % HOST_PERSIST_KEYS] ;
+
+  memcpy( buffer, s_host_persist[key % HOST_PERSIST_KEYS], size ) ;
+
+  return size ;
+}
+
+
+int
+persist_write_int
+( uint32_t key
+, int32_t  value
+)
+{ return persist_write_data( key, &value, sizeof(value) ) ; }
+
+
+int32_t
+persist_read_int
+( uint32_t key )
+{
+  int32_t value = 0 ;
+
+  persist_read_data( key, &value, sizeof(value) ) ;
+
+  return value ;
+}
+
+
+bool
+persist_exists
+( uint32_t key )
+{
+  host_persist_load( ) ;
+
+  return s_host_persistLen[key % HOST_PERSIST_KEYS] > 0 ;
+}
+
+
+int
+persist_delete
+( uint32_t key )
+{
+  host_persist_load( ) ;
+
+  s_host_persistLen[key % HOST_PERSIST_KEYS] = 0 ;
+  host_persist_save( ) ;
+
+  return 0 ;
+}
+
+
+/* -----------   AppMessage   ----------- */
+
+// Outbox delivery acknowledged this long after the send, one message in flight at a time.
+#define HOST_OUTBOX_ACK_MS   300
+
+struct DictionaryIterator { int fieldsNum ; } ;
+
+static DictionaryIterator    s_host_outbox ;
+static AppMessageOutboxSent  s_host_outboxSent ;
+
+
+static
+void
+host_outbox_field
+( const uint32_t  key
+, const char     *format
+, ...
+)
+{
+  if (getenv( "HOST_TELEMETRY" ) == NULL)
+    return ;
+
+  const char *name = (key == MESSAGE_KEY_TelemetryFields ) ? "TelemetryFields"
+                   : (key == MESSAGE_KEY_TelemetryDropped) ? "TelemetryDropped"
+                   : (key == MESSAGE_KEY_TelemetryFrames ) ? "TelemetryFrames"
+                   : "?"
+                   ;
+  va_list args ;
+
+  printf( "%s\"%s\": ", (s_host_outbox.fieldsNum++ == 0) ? "telemetry: {" : ", ", name ) ;
+  va_start( args, format ) ;
+  vprintf( format, args ) ;
+  va_end( args ) ;
+}
+
+
+static
+void
+host_outbox_ack
+( void *data )
+{
+  if (s_host_outboxSent != NULL)
+    s_host_outboxSent( &s_host_outbox, NULL ) ;
+}
+
+
+AppMessageResult       app_message_open( uint32_t size_inbound, uint32_t size_outbound )         { return APP_MSG_OK ; }
+AppMessageOutboxSent   app_message_register_outbox_sent( AppMessageOutboxSent sent_callback )    { return s_host_outboxSent = sent_callback ; }
+AppMessageOutboxFailed app_message_register_outbox_failed( AppMessageOutboxFailed failed_callback ) { return failed_callback ; }
+uint32_t               dict_calc_buffer_size( const uint8_t tuple_count, ... )                 { return 1024 ; }
+
+
+AppMessageResult
+app_message_outbox_begin
+( DictionaryIterator **iterator )
+{
+  s_host_outbox.fieldsNum = 0 ;
+  *iterator = &s_host_outbox ;
+
+  return APP_MSG_OK ;
+}
+
+
+AppMessageResult
+app_message_outbox_send
+( )
+{
+  if (getenv( "HOST_TELEMETRY" ) != NULL)
+    printf( "}\n" ) ;
+
+  app_timer_register( HOST_OUTBOX_ACK_MS, host_outbox_ack, NULL ) ;
+
+  return APP_MSG_OK ;
+}
+
+
+DictionaryResult dict_write_uint8( DictionaryIterator *iterator, uint32_t key, uint8_t value )    { host_outbox_field( key, "%u", value ) ;  return DICT_OK ; }
+DictionaryResult dict_write_uint16( DictionaryIterator *iterator, uint32_t key, uint16_t value )  { host_outbox_field( key, "%u", value ) ;  return DICT_OK ; }
+DictionaryResult dict_write_uint32( DictionaryIterator *iterator, uint32_t key, uint32_t value )  { host_outbox_field( key, "%u", value ) ;  return DICT_OK ; }
+
+
+DictionaryResult
+dict_write_data
+( DictionaryIterator *iterator
+, uint32_t            key
+, const uint8_t      *data
+, uint16_t            size
+)
+{
+  if (getenv( "HOST_TELEMETRY" ) == NULL)
+    return DICT_OK ;
+
+  host_outbox_field( key, "[" ) ;
+
+  for (int i = 0  ;  i < size  ;  ++i)
+    printf( (i == 0) ? "%u" : ",%u", data[i] ) ;
+
+  printf( "]" ) ;
+
+  return DICT_OK ;
+}
+
+
+/* -----------   Event loop   ----------- */
+
+static uint64_t  s_host_hash = 14695981039346656037ull ;   // FNV-1a offset basis.
+
+
+// Clicks of HOST_SCRIPT due after the given frame and that many timer callbacks since.
+static
+void
+host_script_clicks
+( const char *script
+, const int   frame
+, const int   callbacks
+)
+{
+  for (const char *at = script  ;  *at != '\0'  ;  )
+  {
+    char      *end           = NULL ;
+    const int  clickFrame    = (int)strtol( at, &end, 10 ) ;
+    const int  clickCallback = (*end == '+') ? atoi( end + 1 ) : 0 ;
+
+    if ((at = strchr( at, ':' )) == NULL  ||  at[1] == '\0')
+      return ;
+
+    const char button = at[1] ;
+
+    at += (at[2] == ',') ? 3 : 2 ;
+
+    if (clickFrame != frame  ||  clickCallback != callbacks)
+      continue ;
+
+    if (button == 'r')
+    {
+      s_host_dirtyLayer = s_host_drawnLayer ;
+      continue ;
+    }
+
+    ClickHandler handler   = NULL ;
+    ButtonId     longClick = NUM_BUTTONS ;
+
+    switch (button)
+    {
+      case 'u':  handler = s_host_singleClick[BUTTON_ID_UP    ] ;  break ;
+      case 's':  handler = s_host_singleClick[BUTTON_ID_SELECT] ;  break ;
+      case 'd':  handler = s_host_singleClick[BUTTON_ID_DOWN  ] ;  break ;
+      case 'U':  longClick = BUTTON_ID_UP     ;  break ;
+      case 'S':
+      case 'H':  longClick = BUTTON_ID_SELECT ;  break ;
+      case 'D':  longClick = BUTTON_ID_DOWN   ;  break ;
+      case 'm':  handler = s_host_multiClick [BUTTON_ID_SELECT] ;  break ;
+    }
+
+    if (handler != NULL)
+      handler( NULL, NULL ) ;
+
+    // Long clicks released as soon as recognized, or held 2 s more: the clock only jumps ahead for the release.
+    if (longClick != NUM_BUTTONS)
+    {
+      const uint64_t held = (button == 'H') ? 2000 : 0 ;
+
+      if (s_host_longClick[longClick] != NULL)
+        s_host_longClick[longClick]( NULL, NULL ) ;
+
+      s_host_nowMs += held ;
+
+      if (s_host_longUpClick[longClick] != NULL)
+        s_host_longUpClick[longClick]( NULL, NULL ) ;
+
+      s_host_nowMs -= held ;
+    }
+  }
+}
+
+
+static
+void
+host_ppm_write
+( const char *path )
+{
+  FILE *file = fopen( path, "wb" ) ;
+
+  if (file == NULL)
+    return ;
+
+  fprintf( file, "P6 %d %d 255\n", HOST_W, HOST_H ) ;
+
+  for (int y = 0  ;  y < HOST_H  ;  ++y)
+    for (int x = 0  ;  x < HOST_W  ;  ++x)
+    {
+#ifdef PBL_COLOR
+      const GColor8 color = { .argb = s_host_fb[y][x] } ;
+      const uint8_t rgb[3] = { color.r * 85, color.g * 85, color.b * 85 } ;
+#else
+      const uint8_t level  = ((s_host_fb[y][x >> 3] >> (x & 7)) & 1) ? 255 : 0 ;
+      const uint8_t rgb[3] = { level, level, level } ;
+#endif
+      fwrite( rgb, 3, 1, file ) ;
+    }
+
+  fclose( file ) ;
+}
+
+
+void
+app_event_loop
+( )
+{
+  const char *script    = getenv( "HOST_SCRIPT" ) ? getenv( "HOST_SCRIPT" ) : "" ;
+  const int   frames    = getenv( "HOST_FRAMES" ) ? atoi( getenv( "HOST_FRAMES" ) ) : 100 ;
+  int         drawn     = 0 ;
+  int         callbacks = 0 ;    // Timer callbacks since the last frame drawn.
+
+  while (drawn < frames)
+  {
+    // Accelerometer batches due by now.
+    while (s_host_accelHandler != NULL  &&  s_host_nowMs - s_host_accelLastMs >= s_host_accelPeriodMs * s_host_accelBatch)
+    {
+      AccelData batch[32] ;
+
+      for (uint32_t i = 0  ;  i < s_host_accelBatch  &&  i < 32  ;  ++i)
+        batch[i] = host_accel_sample( ) ;
+
+      s_host_accelLastMs += s_host_accelPeriodMs * s_host_accelBatch ;
+      s_host_accelHandler( batch, s_host_accelBatch ) ;
+    }
+
+    // Earliest timer, the clock jumps to its due time.
+    int next = -1 ;
+
+    for (int t = 0  ;  t < HOST_TIMERS_MAX  ;  ++t)
+      if (s_host_timers[t].isArmed  &&  (next < 0  ||  s_host_timers[t].dueMs < s_host_timers[next].dueMs))
+        next = t ;
+
+    if (next < 0)
+      break ;
+
+    if (s_host_timers[next].dueMs > s_host_nowMs)
+      s_host_nowMs = s_host_timers[next].dueMs ;
+
+    s_host_timers[next].isArmed = false ;
+    s_host_timers[next].callback( s_host_timers[next].data ) ;
+
+    host_script_clicks( script, drawn, ++callbacks ) ;
+
+    if (s_host_dirtyLayer == NULL)
+      continue ;
+
+    Layer *layer = s_host_dirtyLayer ;
+
+    s_host_dirtyLayer = NULL ;
+    s_host_drawnLayer = layer ;
+    callbacks         = 0 ;
+    memset( s_host_fb, PBL_IF_COLOR_ELSE(GColorBlack.argb, 0xFF), sizeof(s_host_fb) ) ;
+    layer->updateProc( layer, &s_host_ctx ) ;
+    ++drawn ;
+
+    for (int y = 0  ;  y < HOST_H  ;  ++y)
+      for (int x = 0  ;  x < HOST_W  ;  ++x)
+        s_host_hash = (s_host_hash ^ s_host_fb[y][x]) * 1099511628211ull ;
+
+    if (getenv( "HOST_VERBOSE" ) != NULL)
+      fprintf( stderr, "host:: frame %d hash %016llx\n", drawn, (unsigned long long)s_host_hash ) ;
+
+    host_script_clicks( script, drawn, 0 ) ;
+  }
+
+  if (getenv( "HOST_PPM" ) != NULL)
+    host_ppm_write( getenv( "HOST_PPM" ) ) ;
+
+  printf( "host:: %d frames, hash %016llx, %llu draw calls\n", drawn, (unsigned long long)s_host_hash, (unsigned long long)s_host_drawCalls ) ;
+}
+
+
+// The app's main( ), renamed by build.sh.
+int host_app_main( ) ;
+
+
+int
+main
+( )
+{ return host_app_main( ) ; }
@@ -0,0 +1,58 @@
+#!/bin/bash
+#
+#  WatchApp: Ripples 3D
+#  File    : tools/host/regress.sh
+#  Notes   : Renders the src/c of the working tree and of a git revision on the host, and compares their frame hashes.
+#
+#  Usage   : tools/host/regress.sh [<revision> [FLAG|-FLAG]...]
+#          : Revision defaults to HEAD, flags are toggled in both builds (see build.sh). Every platform runs with GIF on
+#          : and off, under each button script below, for HOST_FRAMES frames (default 40). Exit status 1 if any hash
+#          : differs. The draw call counts are listed, not compared.
+#
+
+HOST=$(cd "$(dirname "$0")" && pwd)
+REPO=$(cd "$HOST/../.." && pwd)
+REVISION=${1:-HEAD}
+shift
+
+SCRIPTS=( ""
+          "1:s,2:s,3:s"
+          "3:s,6:s,9:s,12:s,15:S,18:S,21:u,24:u,27:d,30:D,33:s"
+          "2:S,4:u,6:u,8:d,10:s,12:S,14:s,16:D,18:s,20:d,22:u"
+        )
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+mkdir "$WORK/old" "$WORK/new"
+git -C "$REPO" archive "$REVISION" src/c | tar -x -C "$WORK/old"
+cp -r "$REPO/src" "$WORK/new"
+
+render()
+{
+  local tree=$1 ; shift
+
+  for platform in basalt aplite chalk
+  do
+    for gif in GIF -GIF
+    do
+      rm -f "$WORK/$tree/app"
+      "$HOST/build.sh" -p $platform -s "$WORK/$tree/src/c" -o "$WORK/$tree/app" -- $gif "$@" 2>&1 | grep -E "error|warning|usage|unknown"
+
+      for script in "${SCRIPTS[@]}"
+      do
+        echo "$platform $gif \"$script\": $(HOST_FRAMES=${HOST_FRAMES:-40} HOST_SCRIPT="$script" "$WORK/$tree/app" | grep "^host::")"
+      done
+    done
+  done
+}
+
+render old "$@" > "$WORK/old.txt"
+render new "$@" > "$WORK/new.txt"
+
+# Same hashes, whatever the draw call counts.
+if diff <(sed 's/, [0-9]* draw calls//' "$WORK/old.txt") <(sed 's/, [0-9]* draw calls//' "$WORK/new.txt") > /dev/null
+then
+  echo "IDENTICAL frames to $REVISION" ; cat "$WORK/new.txt"
+else
+  diff "$WORK/old.txt" "$WORK/new.txt" ; exit 1
+fi
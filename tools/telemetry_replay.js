@@ -0,0 +1,56 @@
+#!/usr/bin/env node
+/*
+   WatchApp: Ripples 3D
+   File    : telemetry_replay.js
+   Notes   : Local stand-in for the phone: replays a logged telemetry message stream through src/pkjs/index.js.
+
+   Usage   : node tools/telemetry_replay.js <log> [<csv>]
+           : <log> holds "telemetry: {...}" lines, as logged by index.js (pebble logs) or any other source, other lines
+           : are skipped. Writes the collected CSV to <csv> (stdout if omitted) and the summary to stderr.
+*/
+
+var fs   = require( 'fs' ) ;
+var path = require( 'path' ) ;
+
+var MARKER = 'telemetry: {' ;
+
+if (process.argv.length < 3)
+{
+  console.error( 'usage: node tools/telemetry_replay.js <log> [<csv>]' ) ;
+  process.exit( 2 ) ;
+}
+
+// Stand-in for the PebbleKit JS global: only the event listeners index.js registers.
+var listeners = { } ;
+
+global.Pebble = { addEventListener: function( type, listener ) { (listeners[type] = listeners[type] || [ ]).push( listener ) ; } } ;
+
+// index.js logs every batch it collects, keep the replay output to the CSV and the summary.
+var log     = console.log ;
+console.log = function( ) { } ;
+
+var collector = require( path.join( __dirname, '..', 'src', 'pkjs', 'index.js' ) ) ;
+var replayed  = 0 ;
+
+fs.readFileSync( process.argv[2], 'utf8' ).split( '\n' ).forEach( function( line )
+{
+  var at = line.indexOf( MARKER ) ;
+
+  if (at < 0)
+    return ;
+
+  var payload = JSON.parse( line.slice( at + MARKER.length - 1 ) ) ;
+
+  (listeners.appmessage || [ ]).forEach( function( listener ) { listener( { payload: payload } ) ; } ) ;
+  replayed += 1 ;
+} ) ;
+
+console.log = log ;
+
+if (process.argv.length > 3)
+  fs.writeFileSync( process.argv[3], collector.csv( ) ) ;
+else
+  process.stdout.write( collector.csv( ) ) ;
+
+console.error( replayed + ' messages replayed' ) ;
+console.error( collector.summary( ) ) ;